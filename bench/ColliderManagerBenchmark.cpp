@@ -0,0 +1,478 @@
+#include "src/ColliderManager.h"
+
+#include "Math/AABB.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <optional>
+#include <random>
+#include <vector>
+
+using namespace DYE;
+
+// Count the heap allocations, to report the allocations per operation.
+namespace
+{
+	std::atomic<std::uint64_t> s_AllocationCount = 0;
+}
+
+void* operator new(std::size_t size)
+{
+	s_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+	if (void* pMemory = std::malloc(size == 0? 1 : size))
+	{
+		return pMemory;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pMemory) noexcept
+{
+	std::free(pMemory);
+}
+
+void operator delete(void* pMemory, std::size_t) noexcept
+{
+	std::free(pMemory);
+}
+
+namespace
+{
+	constexpr std::uint32_t QueryCount = 1'000;
+	constexpr std::uint32_t DefaultMaxColliderCount = 1'000'000;
+	// The share of the colliders unregistered and registered again, and moved, by the update benchmarks.
+	constexpr float ChurnRatio = 0.1f;
+
+	enum class Distribution
+	{
+		// Boxes of about the same size spread evenly.
+		Uniform,
+		// Boxes packed around a few centers with empty space in between.
+		Clustered,
+		// Long thin horizontal or vertical boxes, e.g. walls, which overlap many grid cells and make loose tree nodes.
+		LongThin
+	};
+
+	char const* getDistributionName(Distribution distribution)
+	{
+		switch (distribution)
+		{
+			case Distribution::Uniform: return "Uniform";
+			case Distribution::Clustered: return "Clustered";
+			case Distribution::LongThin: return "LongThin";
+		}
+		return "";
+	}
+
+	char const* getBroadPhaseName(BroadPhaseType type)
+	{
+		switch (type)
+		{
+			case BroadPhaseType::Linear: return "Linear";
+			case BroadPhaseType::DynamicAABBTree: return "AABBTree";
+			case BroadPhaseType::SpatialHashGrid: return "HashGrid";
+		}
+		return "";
+	}
+
+	struct Query
+	{
+		Math::AABB AABB;
+		glm::vec2 Center;
+		float Radius;
+		glm::vec2 End;
+	};
+
+	struct Scene
+	{
+		std::vector<Math::AABB> Boxes;
+		// The boxes the update benchmarks move the colliders to.
+		std::vector<Math::AABB> MovedBoxes;
+		std::vector<Query> Queries;
+	};
+
+	/// The world grows with the number of colliders so the density, and the results per query, stay about the same.
+	Scene createScene(std::uint32_t colliderCount, Distribution distribution)
+	{
+		std::mt19937 random(colliderCount);
+		float const worldHalfSize = 2.0f * glm::sqrt((float) colliderCount);
+		std::uniform_real_distribution<float> position(-worldHalfSize, worldHalfSize);
+		std::uniform_real_distribution<float> size(0.5f, 2.0f);
+		std::uniform_real_distribution<float> length(10.0f, 40.0f);
+		std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+
+		std::vector<glm::vec2> clusterCenters;
+		for (std::uint32_t i = 0; i < 32; i++)
+		{
+			clusterCenters.push_back({position(random), position(random)});
+		}
+		std::normal_distribution<float> clusterSpread(0.0f, worldHalfSize / 32.0f);
+
+		auto createBox = [&]()
+		{
+			switch (distribution)
+			{
+				case Distribution::Uniform:
+					return Math::AABB::CreateFromCenter({position(random), position(random), 0}, {size(random), size(random), 0});
+				case Distribution::Clustered:
+				{
+					glm::vec2 const clusterCenter = clusterCenters[random() % clusterCenters.size()];
+					return Math::AABB::CreateFromCenter({clusterCenter.x + clusterSpread(random), clusterCenter.y + clusterSpread(random), 0}, {size(random), size(random), 0});
+				}
+				case Distribution::LongThin:
+				{
+					bool const isHorizontal = random() % 2 == 0;
+					glm::vec3 const boxSize = isHorizontal? glm::vec3 {length(random), 0.2f, 0} : glm::vec3 {0.2f, length(random), 0};
+					return Math::AABB::CreateFromCenter({position(random), position(random), 0}, boxSize);
+				}
+			}
+			return Math::AABB {};
+		};
+
+		Scene scene;
+		scene.Boxes.reserve(colliderCount);
+		scene.MovedBoxes.reserve(colliderCount);
+		for (std::uint32_t i = 0; i < colliderCount; i++)
+		{
+			Math::AABB const aabb = createBox();
+			scene.Boxes.push_back(aabb);
+
+			// Small steps, like a collider moving for one frame.
+			glm::vec3 const step {offset(random), offset(random), 0};
+			scene.MovedBoxes.push_back(Math::AABB {.Min = aabb.Min + step, .Max = aabb.Max + step});
+		}
+
+		// Query where the colliders are, the box of a random collider is a good sample of the distribution.
+		for (std::uint32_t i = 0; i < QueryCount; i++)
+		{
+			Math::AABB const& target = scene.Boxes[random() % colliderCount];
+			glm::vec2 const center {(target.Min.x + target.Max.x) * 0.5f, (target.Min.y + target.Max.y) * 0.5f};
+			glm::vec2 const end = center + glm::vec2 {offset(random), offset(random)} * 20.0f;
+			scene.Queries.push_back(Query
+			{
+				.AABB = Math::AABB::CreateFromCenter({center, 0}, {4.0f, 4.0f, 0}),
+				.Center = center,
+				.Radius = 2.0f,
+				.End = end
+			});
+		}
+
+		return scene;
+	}
+
+	struct Measure
+	{
+		double NanosecondsPerOperation;
+		double AllocationsPerOperation;
+		double CandidatesPerOperation;
+		double ResultsPerOperation;
+	};
+
+	/// \param operation std::uint64_t(std::uint32_t index), run operationCount times, returns its number of results.
+	template<typename Operation>
+	Measure measure(std::uint32_t operationCount, Operation&& operation)
+	{
+		ColliderManager::ResetThreadQueryStats();
+		std::uint64_t const allocationCountBefore = s_AllocationCount.load(std::memory_order_relaxed);
+		std::uint64_t resultCount = 0;
+
+		auto const startTime = std::chrono::steady_clock::now();
+		for (std::uint32_t i = 0; i < operationCount; i++)
+		{
+			resultCount += operation(i);
+		}
+		auto const endTime = std::chrono::steady_clock::now();
+
+		std::uint64_t const allocationCount = s_AllocationCount.load(std::memory_order_relaxed) - allocationCountBefore;
+		return Measure
+		{
+			.NanosecondsPerOperation = std::chrono::duration<double, std::nano>(endTime - startTime).count() / operationCount,
+			.AllocationsPerOperation = (double) allocationCount / operationCount,
+			.CandidatesPerOperation = (double) ColliderManager::GetThreadQueryStats().CandidateCount / operationCount,
+			.ResultsPerOperation = (double) resultCount / operationCount
+		};
+	}
+
+	void printMeasure(char const* broadPhaseName, char const* distributionName, std::uint32_t colliderCount, char const* operationName, Measure const& result)
+	{
+		std::printf("%-9s %-10s %8u  %-14s %12.1f ns/op  %6.2f allocs/op  %10.1f candidates/op  %8.1f results/op\n",
+					broadPhaseName, distributionName, colliderCount, operationName, result.NanosecondsPerOperation,
+					result.AllocationsPerOperation, result.CandidatesPerOperation, result.ResultsPerOperation);
+	}
+
+	void benchmarkScene(BroadPhaseType broadPhaseType, Distribution distribution, std::uint32_t colliderCount, Scene const& scene)
+	{
+		char const* broadPhaseName = getBroadPhaseName(broadPhaseType);
+		char const* distributionName = getDistributionName(distribution);
+		auto print = [&](char const* operationName, Measure const& result)
+		{
+			printMeasure(broadPhaseName, distributionName, colliderCount, operationName, result);
+		};
+
+		ColliderManager colliderManager {BroadPhaseSettings {.Type = broadPhaseType}};
+		std::vector<ColliderID> ids(colliderCount);
+
+		print("RegisterAABB", measure(colliderCount, [&](std::uint32_t i)
+		{
+			ids[i] = colliderManager.RegisterAABB(scene.Boxes[i]);
+			return 0;
+		}));
+
+		// Unregister then register again a share of the colliders, like objects being destroyed and spawned.
+		std::uint32_t const churnCount = std::max(1u, (std::uint32_t) (colliderCount * ChurnRatio));
+		std::uint32_t const churnStride = colliderCount / churnCount;
+		print("Churn", measure(churnCount, [&](std::uint32_t i)
+		{
+			std::uint32_t const index = i * churnStride;
+			colliderManager.UnregisterAABB(ids[index]);
+			ids[index] = colliderManager.RegisterAABB(scene.Boxes[index]);
+			return 0;
+		}));
+
+		print("SetAABB", measure(colliderCount, [&](std::uint32_t i)
+		{
+			colliderManager.SetAABB(ids[i], scene.MovedBoxes[i]);
+			return 0;
+		}));
+
+		// Every collider moved back in one batch, the cost of the broad-phase update is spread over the batch.
+		print("SetAABBs", measure(colliderCount, [&](std::uint32_t i)
+		{
+			if (i == 0)
+			{
+				colliderManager.BeginUpdate();
+			}
+			colliderManager.SetAABBs({&ids[i], 1}, {&scene.Boxes[i], 1});
+			if (i == colliderCount - 1)
+			{
+				colliderManager.EndUpdate();
+			}
+			return 0;
+		}));
+
+		// The buffers are warmed up by a first pass, so only the allocations of the queries themselves are counted.
+		std::vector<ColliderID> overlaps;
+		std::vector<RaycastHit2D> hits;
+		for (Query const& query : scene.Queries)
+		{
+			colliderManager.OverlapAABB(query.AABB, overlaps);
+			colliderManager.CircleCastAll(query.Center, query.Radius, query.End - query.Center, hits);
+		}
+
+		print("OverlapAABB", measure(QueryCount, [&](std::uint32_t i)
+		{
+			colliderManager.OverlapAABB(scene.Queries[i].AABB, overlaps);
+			return overlaps.size();
+		}));
+
+		print("OverlapCircle", measure(QueryCount, [&](std::uint32_t i)
+		{
+			colliderManager.OverlapCircle(scene.Queries[i].Center, scene.Queries[i].Radius, overlaps);
+			return overlaps.size();
+		}));
+
+		print("RaycastAll", measure(QueryCount, [&](std::uint32_t i)
+		{
+			colliderManager.RaycastAll(scene.Queries[i].Center, scene.Queries[i].End, hits);
+			return hits.size();
+		}));
+
+		print("Raycast", measure(QueryCount, [&](std::uint32_t i)
+		{
+			return colliderManager.Raycast(scene.Queries[i].Center, scene.Queries[i].End).has_value()? 1 : 0;
+		}));
+
+		print("CircleCastAll", measure(QueryCount, [&](std::uint32_t i)
+		{
+			Query const& query = scene.Queries[i];
+			colliderManager.CircleCastAll(query.Center, query.Radius, query.End - query.Center, hits);
+			return hits.size();
+		}));
+
+		print("CircleCast", measure(QueryCount, [&](std::uint32_t i)
+		{
+			Query const& query = scene.Queries[i];
+			return colliderManager.CircleCast(query.Center, query.Radius, query.End - query.Center).has_value()? 1 : 0;
+		}));
+	}
+
+	std::vector<ColliderID> sortedIDsOf(std::vector<ColliderID> ids)
+	{
+		std::sort(ids.begin(), ids.end(), [](ColliderID const& lhs, ColliderID const& rhs) { return lhs.Index < rhs.Index; });
+		return ids;
+	}
+
+	std::vector<ColliderID> sortedIDsOf(std::vector<RaycastHit2D> const& hits)
+	{
+		std::vector<ColliderID> ids;
+		for (RaycastHit2D const& hit : hits)
+		{
+			ids.push_back(hit.ColliderID);
+		}
+		return sortedIDsOf(std::move(ids));
+	}
+
+	/// The nearest hits may be different colliders if they are tied, only the times have to match.
+	bool isSameNearestHit(std::optional<RaycastHit2D> const& hit, std::optional<RaycastHit2D> const& referenceHit)
+	{
+		if (hit.has_value() != referenceHit.has_value())
+		{
+			return false;
+		}
+		return !hit.has_value() || glm::abs(hit->Time - referenceHit->Time) <= 0.0001f * glm::max(1.0f, glm::abs(referenceHit->Time));
+	}
+
+	/// Run every query on each broad-phase and compare the results to the linear scan.
+	/// \return false if a broad-phase has returned different results.
+	bool verifyScene(Distribution distribution, std::uint32_t colliderCount, Scene const& scene)
+	{
+		ColliderManager reference {BroadPhaseSettings {.Type = BroadPhaseType::Linear}};
+		for (Math::AABB const& aabb : scene.Boxes)
+		{
+			reference.RegisterAABB(aabb);
+		}
+
+		bool isMatched = true;
+		for (auto const broadPhaseType : {BroadPhaseType::DynamicAABBTree, BroadPhaseType::SpatialHashGrid})
+		{
+			ColliderManager colliderManager {BroadPhaseSettings {.Type = broadPhaseType}};
+			for (Math::AABB const& aabb : scene.Boxes)
+			{
+				colliderManager.RegisterAABB(aabb);
+			}
+
+			std::uint32_t mismatchCount = 0;
+			for (Query const& query : scene.Queries)
+			{
+				glm::vec2 const direction = query.End - query.Center;
+				bool const isMatchedQuery =
+					sortedIDsOf(colliderManager.OverlapAABB(query.AABB)) == sortedIDsOf(reference.OverlapAABB(query.AABB)) &&
+					sortedIDsOf(colliderManager.OverlapCircle(query.Center, query.Radius)) == sortedIDsOf(reference.OverlapCircle(query.Center, query.Radius)) &&
+					sortedIDsOf(colliderManager.RaycastAll(query.Center, query.End)) == sortedIDsOf(reference.RaycastAll(query.Center, query.End)) &&
+					sortedIDsOf(colliderManager.CircleCastAll(query.Center, query.Radius, direction)) ==
+						sortedIDsOf(reference.CircleCastAll(query.Center, query.Radius, direction)) &&
+					isSameNearestHit(colliderManager.Raycast(query.Center, query.End), reference.Raycast(query.Center, query.End)) &&
+					isSameNearestHit(colliderManager.CircleCast(query.Center, query.Radius, direction), reference.CircleCast(query.Center, query.Radius, direction));
+				mismatchCount += isMatchedQuery? 0 : 1;
+			}
+
+			if (mismatchCount > 0)
+			{
+				std::printf("%-9s %-10s %8u  MISMATCH: %u of %u queries differ from the linear scan\n", getBroadPhaseName(broadPhaseType),
+							getDistributionName(distribution), colliderCount, mismatchCount, QueryCount);
+			}
+			isMatched = isMatched && mismatchCount == 0;
+		}
+
+		return isMatched;
+	}
+
+	bool isNearlyEqual(float value, float reference)
+	{
+		return glm::abs(value - reference) <= 0.001f * glm::max(1.0f, glm::abs(reference));
+	}
+
+	bool isSameHit(RaycastHit2D const& hit, RaycastHit2D const& referenceHit)
+	{
+		return hit.ColliderID == referenceHit.ColliderID && isNearlyEqual(hit.Time, referenceHit.Time) &&
+			   isNearlyEqual(hit.Centroid.x, referenceHit.Centroid.x) && isNearlyEqual(hit.Centroid.y, referenceHit.Centroid.y) &&
+			   isNearlyEqual(hit.Normal.x, referenceHit.Normal.x) && isNearlyEqual(hit.Normal.y, referenceHit.Normal.y);
+	}
+
+	std::vector<RaycastHit2D> sortedByID(std::vector<RaycastHit2D> hits)
+	{
+		std::sort(hits.begin(), hits.end(), [](RaycastHit2D const& lhs, RaycastHit2D const& rhs) { return lhs.ColliderID.Index < rhs.ColliderID.Index; });
+		return hits;
+	}
+
+	/// Compare the circle casts against the colliders inflated by a registered radius to the engine test on the plain colliders.
+	/// Besides the scene queries, every box is also cast at from outside one of its corners, where the inflated box is rounded.
+	/// \return false if a hit has a different time, centroid or normal.
+	bool verifyInflatedCircleCasts(Distribution distribution, std::uint32_t colliderCount, Scene const& scene)
+	{
+		constexpr float radius = 2.0f;
+
+		ColliderManager reference {BroadPhaseSettings {.Type = BroadPhaseType::Linear}};
+		ColliderManager cached {BroadPhaseSettings {.Type = BroadPhaseType::Linear}};
+		cached.RegisterCircleCastRadius(radius);
+		for (Math::AABB const& aabb : scene.Boxes)
+		{
+			reference.RegisterAABB(aabb);
+			cached.RegisterAABB(aabb);
+		}
+
+		std::vector<Query> queries = scene.Queries;
+		std::mt19937 random(colliderCount);
+		std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+		for (std::uint32_t i = 0; i < QueryCount; i++)
+		{
+			Math::AABB const& target = scene.Boxes[random() % colliderCount];
+			glm::vec2 const side {random() % 2 == 0? -1.0f : 1.0f, random() % 2 == 0? -1.0f : 1.0f};
+			glm::vec2 const corner {side.x > 0.0f? target.Max.x : target.Min.x, side.y > 0.0f? target.Max.y : target.Min.y};
+			glm::vec2 const center = corner + side * (radius + 1.0f) + glm::vec2 {offset(random), offset(random)};
+			queries.push_back(Query {.Center = center, .Radius = radius, .End = corner + (corner - center)});
+		}
+
+		std::uint32_t mismatchCount = 0;
+		for (Query const& query : queries)
+		{
+			glm::vec2 const direction = query.End - query.Center;
+			std::vector<RaycastHit2D> const hits = sortedByID(cached.CircleCastAll(query.Center, radius, direction));
+			std::vector<RaycastHit2D> const referenceHits = sortedByID(reference.CircleCastAll(query.Center, radius, direction));
+
+			bool isMatchedQuery = hits.size() == referenceHits.size();
+			for (std::size_t i = 0; isMatchedQuery && i < hits.size(); i++)
+			{
+				isMatchedQuery = isSameHit(hits[i], referenceHits[i]);
+			}
+			mismatchCount += isMatchedQuery? 0 : 1;
+		}
+
+		if (mismatchCount > 0)
+		{
+			std::printf("%-9s %-10s %8u  MISMATCH: %u of %zu circle casts differ with a registered radius\n", "Inflated",
+						getDistributionName(distribution), colliderCount, mismatchCount, queries.size());
+		}
+		return mismatchCount == 0;
+	}
+}
+
+/// Usage: DYETechDemoCollisionBench [max collider count], the collider counts go from 100 up to the max count by powers of 10.
+/// Returns 1 if a broad-phase doesn't return the same results as the linear scan, or if the casts against the inflated colliders
+/// don't return the same hits as the engine test.
+int main(int argc, char** argv)
+{
+	std::uint32_t const maxColliderCount = argc > 1? (std::uint32_t) std::strtoul(argv[1], nullptr, 10) : DefaultMaxColliderCount;
+	bool isMatched = true;
+
+#if !defined(DYE_COLLIDER_QUERY_STATS)
+	std::printf("DYE_COLLIDER_QUERY_STATS is not defined, the candidates are not counted.\n\n");
+#endif
+
+	for (std::uint32_t colliderCount = 100; colliderCount <= maxColliderCount; colliderCount *= 10)
+	{
+		for (auto const distribution : {Distribution::Uniform, Distribution::Clustered, Distribution::LongThin})
+		{
+			Scene const scene = createScene(colliderCount, distribution);
+			for (auto const broadPhaseType : {BroadPhaseType::Linear, BroadPhaseType::DynamicAABBTree, BroadPhaseType::SpatialHashGrid})
+			{
+				benchmarkScene(broadPhaseType, distribution, colliderCount, scene);
+			}
+			isMatched &= verifyScene(distribution, colliderCount, scene);
+			isMatched &= verifyInflatedCircleCasts(distribution, colliderCount, scene);
+			std::printf("\n");
+		}
+	}
+
+	if (!isMatched)
+	{
+		std::printf("Some broad-phases don't match the linear scan!\n");
+		return 1;
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,197 @@
+#include "src/CollisionKernels.h"
+
+#include "Math/AABB.h"
+#include "Math/PrimitiveTest.h"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace DYE;
+
+namespace
+{
+	constexpr std::uint32_t QueryCount = 200;
+	constexpr float WorldHalfSize = 500.0f;
+
+	struct Query
+	{
+		glm::vec2 Center;
+		glm::vec2 Displacement;
+		float Radius;
+	};
+
+	struct Scene
+	{
+		std::vector<Math::AABB> Boxes;
+		AABBStreams Streams;
+		std::vector<Query> Queries;
+	};
+
+	Scene createScene(std::uint32_t boxCount)
+	{
+		std::mt19937 random(boxCount);
+		std::uniform_real_distribution<float> position(-WorldHalfSize, WorldHalfSize);
+		std::uniform_real_distribution<float> size(0.5f, 4.0f);
+		std::uniform_real_distribution<float> radius(0.25f, 8.0f);
+
+		Scene scene;
+		scene.Boxes.reserve(boxCount);
+		for (std::uint32_t i = 0; i < boxCount; i++)
+		{
+			Math::AABB const aabb = Math::AABB::CreateFromCenter({position(random), position(random), 0}, {size(random), size(random), 0});
+			scene.Boxes.push_back(aabb);
+			scene.Streams.PushBack(aabb);
+		}
+
+		for (std::uint32_t i = 0; i < QueryCount; i++)
+		{
+			glm::vec2 const center {position(random), position(random)};
+			glm::vec2 const end {position(random), position(random)};
+			scene.Queries.push_back({center, (end - center) * 0.1f, radius(random)});
+		}
+
+		return scene;
+	}
+
+	/// Run the kernel over the whole streams for every query, confirm the candidates with the exact test.
+	/// \return the number of confirmed hits, which must be the same for every instruction set.
+	template<typename Kernel, typename ExactTest>
+	std::uint64_t runKernel(Scene const& scene, Kernel&& kernel, ExactTest&& exactTest, double& outMilliseconds)
+	{
+		std::array<std::uint32_t, CollisionKernels::ChunkSize> candidates;
+		std::uint64_t hitCount = 0;
+
+		auto const startTime = std::chrono::steady_clock::now();
+		for (Query const& query : scene.Queries)
+		{
+			for (std::uint32_t begin = 0; begin < scene.Streams.Size(); begin += CollisionKernels::ChunkSize)
+			{
+				std::uint32_t const end = std::min(begin + CollisionKernels::ChunkSize, scene.Streams.Size());
+				std::uint32_t const candidateCount = kernel(query, begin, end, candidates.data());
+				for (std::uint32_t i = 0; i < candidateCount; i++)
+				{
+					hitCount += exactTest(query, scene.Boxes[candidates[i]])? 1 : 0;
+				}
+			}
+		}
+		auto const endTime = std::chrono::steady_clock::now();
+
+		outMilliseconds = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+		return hitCount;
+	}
+
+	/// The array of structs loop the kernels replace.
+	template<typename ExactTest>
+	std::uint64_t runReference(Scene const& scene, ExactTest&& exactTest, double& outMilliseconds)
+	{
+		std::uint64_t hitCount = 0;
+
+		auto const startTime = std::chrono::steady_clock::now();
+		for (Query const& query : scene.Queries)
+		{
+			for (Math::AABB const& aabb : scene.Boxes)
+			{
+				hitCount += exactTest(query, aabb)? 1 : 0;
+			}
+		}
+		auto const endTime = std::chrono::steady_clock::now();
+
+		outMilliseconds = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+		return hitCount;
+	}
+
+	template<typename KernelOfSet, typename ExactTest>
+	bool benchmarkKernel(char const* kernelName, Scene const& scene, KernelOfSet&& kernelOfSet, ExactTest&& exactTest)
+	{
+		double referenceMilliseconds;
+		std::uint64_t const referenceHitCount = runReference(scene, exactTest, referenceMilliseconds);
+		std::printf("%-14s %8u  %-10s %10.3f ms  %6.2fx  hits %llu\n", kernelName, scene.Streams.Size(), "Reference",
+					referenceMilliseconds, 1.0, (unsigned long long) referenceHitCount);
+
+		bool isMatched = true;
+		for (auto const instructionSet : {CollisionKernels::InstructionSet::Scalar, CollisionKernels::InstructionSet::SSE, CollisionKernels::InstructionSet::AVX2})
+		{
+			if (!CollisionKernels::IsInstructionSetSupported(instructionSet))
+			{
+				continue;
+			}
+
+			double milliseconds;
+			std::uint64_t const hitCount = runKernel(scene, kernelOfSet(instructionSet), exactTest, milliseconds);
+			std::printf("%-14s %8u  %-10s %10.3f ms  %6.2fx  hits %llu%s\n", kernelName, scene.Streams.Size(),
+						CollisionKernels::GetInstructionSetName(instructionSet), milliseconds, referenceMilliseconds / milliseconds,
+						(unsigned long long) hitCount, hitCount == referenceHitCount? "" : "  MISMATCH");
+
+			isMatched = isMatched && hitCount == referenceHitCount;
+		}
+
+		return isMatched;
+	}
+}
+
+int main()
+{
+	std::printf("Best supported instruction set: %s\n\n", CollisionKernels::GetInstructionSetName(CollisionKernels::GetBestInstructionSet()));
+
+	bool isMatched = true;
+	for (std::uint32_t const boxCount : {1'000u, 10'000u, 100'000u})
+	{
+		Scene const scene = createScene(boxCount);
+
+		isMatched &= benchmarkKernel("OverlapBox", scene,
+			[&](CollisionKernels::InstructionSet instructionSet)
+			{
+				return [&, instructionSet](Query const& query, std::uint32_t begin, std::uint32_t end, std::uint32_t* outIndices)
+				{
+					glm::vec2 const extents {query.Radius, query.Radius};
+					return CollisionKernels::OverlapBox(scene.Streams, begin, end, query.Center - extents, query.Center + extents, outIndices, instructionSet);
+				};
+			},
+			[](Query const& query, Math::AABB const& aabb)
+			{
+				Math::AABB const queryAABB {.Min = {query.Center - glm::vec2 {query.Radius, query.Radius}, 0}, .Max = {query.Center + glm::vec2 {query.Radius, query.Radius}, 0}};
+				return Math::AABBAABBIntersect2D(aabb, queryAABB);
+			});
+
+		isMatched &= benchmarkKernel("OverlapCircle", scene,
+			[&](CollisionKernels::InstructionSet instructionSet)
+			{
+				return [&, instructionSet](Query const& query, std::uint32_t begin, std::uint32_t end, std::uint32_t* outIndices)
+				{
+					return CollisionKernels::OverlapCircle(scene.Streams, begin, end, query.Center, query.Radius, outIndices, instructionSet);
+				};
+			},
+			[](Query const& query, Math::AABB const& aabb)
+			{
+				return Math::AABBCircleIntersect(aabb, query.Center, query.Radius);
+			});
+
+		isMatched &= benchmarkKernel("CircleCast", scene,
+			[&](CollisionKernels::InstructionSet instructionSet)
+			{
+				return [&, instructionSet](Query const& query, std::uint32_t begin, std::uint32_t end, std::uint32_t* outIndices)
+				{
+					BroadPhaseSegment const segment = BroadPhaseSegment::Create(query.Center, query.Displacement);
+					return CollisionKernels::SweptBox(scene.Streams, begin, end, segment, {query.Radius, query.Radius}, 1.0f, outIndices, instructionSet);
+				};
+			},
+			[](Query const& query, Math::AABB const& aabb)
+			{
+				Math::DynamicTestResult2D result;
+				return Math::MovingCircleAABBIntersect(query.Center, query.Radius, query.Displacement, aabb, result);
+			});
+
+		std::printf("\n");
+	}
+
+	if (!isMatched)
+	{
+		std::printf("Some kernels don't match the reference results!\n");
+		return 1;
+	}
+
+	return 0;
+}
\ No newline at end of file
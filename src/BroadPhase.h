@@ -0,0 +1,127 @@
+#pragma once
+
+#include "Math/AABB.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <utility>
+
+namespace DYE
+{
+	enum class BroadPhaseType
+	{
+		Linear,			// Test every registered collider with the SIMD kernels, this is the reference backend.
+		DynamicAABBTree,
+		SpatialHashGrid	// Best for bounded arenas full of similar-sized colliders.
+	};
+
+	struct BroadPhaseSettings
+	{
+		BroadPhaseType Type = BroadPhaseType::DynamicAABBTree;
+
+		// The margin added to each side of a leaf AABB in the tree,
+		// a collider can move within the fattened AABB without being reinserted.
+		float AABBTreeFatMargin = 0.1f;
+
+		// How far ahead, in seconds, the tree predicts the colliders given a velocity with ColliderManager::SetVelocity().
+		// Their leaf is stretched along the displacement over that time, so they are reinserted every few steps instead of every step.
+		float AABBTreePredictionTime = 1.0f / 15.0f;
+
+		// The size of a grid cell, ideally close to the size of a typical collider.
+		float SpatialHashGridCellSize = 2.0f;
+
+		// Keep every overlapping pair of colliders with an incremental sweep and prune, see ColliderManager::UpdateContactPairs().
+		// Each registered collider costs a little more to update, leave it off unless the pairs are needed.
+		bool TrackContactPairs = false;
+	};
+
+	/// A 2D line segment used by the broad-phase to cast against bounding boxes.
+	/// The segment goes from Start to Start + Displacement, a point on the segment is described by a fraction in [0, 1].
+	struct BroadPhaseSegment
+	{
+		glm::vec2 Start;
+		glm::vec2 Displacement;
+		glm::vec2 InverseDisplacement;
+		bool IsParallelX;
+		bool IsParallelY;
+
+		static BroadPhaseSegment Create(glm::vec2 start, glm::vec2 displacement)
+		{
+			BroadPhaseSegment segment;
+			segment.Start = start;
+			segment.Displacement = displacement;
+			segment.IsParallelX = displacement.x == 0.0f;
+			segment.IsParallelY = displacement.y == 0.0f;
+			segment.InverseDisplacement.x = segment.IsParallelX? 0.0f : 1.0f / displacement.x;
+			segment.InverseDisplacement.y = segment.IsParallelY? 0.0f : 1.0f / displacement.y;
+			return segment;
+		}
+
+		/// Slab test against the given 2D box.
+		/// \param maxFraction the test is limited to [0, maxFraction] of the segment.
+		/// \param outEntryFraction the fraction at which the segment enters the box (0 if the start point is inside).
+		/// \return true if the segment overlaps with the box.
+		bool IntersectBox(glm::vec2 boxMin, glm::vec2 boxMax, float maxFraction, float& outEntryFraction) const
+		{
+			float tMin = 0.0f;
+			float tMax = maxFraction;
+
+			if (IsParallelX)
+			{
+				if (Start.x < boxMin.x || Start.x > boxMax.x)
+				{
+					return false;
+				}
+			}
+			else
+			{
+				float t1 = (boxMin.x - Start.x) * InverseDisplacement.x;
+				float t2 = (boxMax.x - Start.x) * InverseDisplacement.x;
+				if (t1 > t2)
+				{
+					std::swap(t1, t2);
+				}
+				tMin = glm::max(tMin, t1);
+				tMax = glm::min(tMax, t2);
+				if (tMin > tMax)
+				{
+					return false;
+				}
+			}
+
+			if (IsParallelY)
+			{
+				if (Start.y < boxMin.y || Start.y > boxMax.y)
+				{
+					return false;
+				}
+			}
+			else
+			{
+				float t1 = (boxMin.y - Start.y) * InverseDisplacement.y;
+				float t2 = (boxMax.y - Start.y) * InverseDisplacement.y;
+				if (t1 > t2)
+				{
+					std::swap(t1, t2);
+				}
+				tMin = glm::max(tMin, t1);
+				tMax = glm::min(tMax, t2);
+				if (tMin > tMax)
+				{
+					return false;
+				}
+			}
+
+			outEntryFraction = tMin;
+			return true;
+		}
+	};
+
+	/// The squared distance from the point to the nearest point of the box, 0 if the point is inside.
+	inline float PointBoxDistanceSquared(glm::vec2 point, glm::vec2 boxMin, glm::vec2 boxMax)
+	{
+		glm::vec2 const offset = point - glm::clamp(point, boxMin, boxMax);
+		return glm::dot(offset, offset);
+	}
+}
\ No newline at end of file
@@ -1,191 +1,1352 @@
 #include "ColliderManager.h"
+#include "ColliderSnapshot.h"
 
-#include "ImGui/ImGuiUtil.h"
-#include "Graphics/DebugDraw.h"
-#include "Math/Color.h"
-
-#include <imgui.h>
-#include <string>
 #include <algorithm>
+#include <bit>
 
 namespace DYE
 {
+	ColliderManager::ColliderManager(BroadPhaseSettings broadPhaseSettings) :
+		m_BroadPhaseSettings(broadPhaseSettings),
+		m_AABBTree(broadPhaseSettings.AABBTreeFatMargin),
+		m_SpatialHashGrid(broadPhaseSettings.SpatialHashGridCellSize)
+	{
+	}
+
+	ColliderID ColliderManager::RegisterAABB(Math::AABB aabb, CollisionFilter filter, ColliderUserData userData, ColliderMobility mobility)
+	{
+		return registerCollider(aabb, filter, userData, false, mobility == ColliderMobility::Static);
+	}
+
+	ColliderID ColliderManager::RegisterOBB(OrientedBox2D const& box, CollisionFilter filter, ColliderUserData userData, ColliderMobility mobility)
+	{
+		ColliderID const id = registerCollider(box.GetBounds(), filter, userData, false, mobility == ColliderMobility::Static);
+		if (id.IsValid())
+		{
+			std::uint32_t const denseIndex = denseIndexOf(id);
+			m_Colliders[denseIndex].OrientedBox = box;
+			m_Colliders[denseIndex].IsOriented = true;
+			m_ColliderBoxes.Set(denseIndex, box);
+		}
+		return id;
+	}
 
-	ColliderID ColliderManager::RegisterAABB(Math::AABB aabb)
+	ColliderID ColliderManager::RegisterSensorAABB(Math::AABB aabb, CollisionFilter filter, ColliderUserData userData)
 	{
-		ColliderID const id = m_AABBIdCounter;
-		m_AABBs.emplace_back(id, aabb);
-		m_AABBIdCounter++;
+		ColliderID const id = registerCollider(aabb, filter, userData, true, false);
+		if (id.IsValid())
+		{
+			m_Sensors.push_back(Sensor {.ID = id, .Contacts = {}});
+		}
 		return id;
 	}
 
+	ColliderID ColliderManager::registerCollider(Math::AABB const& aabb, CollisionFilter const& filter, ColliderUserData userData, bool isSensor, bool isStatic)
+	{
+		std::uint32_t slotIndex;
+		if (m_FreeSlotHead != ColliderID::InvalidIndex)
+		{
+			// Reuse the slot that has been free for the longest time.
+			slotIndex = m_FreeSlotHead;
+			m_FreeSlotHead = m_Slots[slotIndex].DenseIndexOrNextFree;
+			if (m_FreeSlotHead == ColliderID::InvalidIndex)
+			{
+				m_FreeSlotTail = ColliderID::InvalidIndex;
+			}
+		}
+		else
+		{
+			if (m_Slots.size() >= ColliderID::InvalidIndex)
+			{
+				// Every slot has been used up.
+				return {};
+			}
+
+			slotIndex = (std::uint32_t) m_Slots.size();
+			m_Slots.emplace_back();
+		}
+
+		Slot& slot = m_Slots[slotIndex];
+		slot.IsInUse = true;
+		slot.DenseIndexOrNextFree = (std::uint32_t) m_Colliders.size();
+
+		Collider collider
+		{
+			.AABB = aabb,
+			.OrientedBox = OrientedBox2D::CreateFromAABB(aabb),
+			.Velocity = {0, 0},
+			.Filter = filter,
+			.UserData = userData,
+			.IsSensor = isSensor,
+			.IsStatic = isStatic
+		};
+		if (isInStaticBVH(collider))
+		{
+			m_IsStaticBVHDirty = true;
+		}
+
+		if (!isSensor)
+		{
+			// Nothing looks for sensors in the broad-phase, they only query it.
+			if (!isInStaticBVH(collider))
+			{
+				collider.BroadPhaseProxyID = createBroadPhaseProxy(aabb, slotIndex, filter.CategoryBits);
+			}
+			if (m_BroadPhaseSettings.TrackContactPairs)
+			{
+				ColliderID const id {slotIndex, slot.Generation};
+				collider.ContactPairProxyID = m_ContactPairs.CreateProxy(aabb, contactUserDataOf(id), filter.CategoryBits, filter.MaskBits);
+			}
+		}
+
+		m_Colliders.emplace_back(collider);
+		m_DenseToSlot.emplace_back(slotIndex);
+		m_ColliderBounds.PushBack(aabb);
+		m_ColliderBoxes.PushBack(collider.OrientedBox);
+		for (InflatedAABBCache& cache : m_InflatedAABBCaches)
+		{
+			cache.Bounds.PushBack(inflateAABB(aabb, cache.Radius));
+		}
+		markSnapshotDirty(slotIndex);
+
+		return {slotIndex, slot.Generation};
+	}
+
 	void ColliderManager::UnregisterAABB(ColliderID id)
 	{
-		int index = binarySearchIndexOf(m_AABBs, id);
-		if (index == -1)
+		std::uint32_t const denseIndex = denseIndexOf(id);
+		if (denseIndex == ColliderID::InvalidIndex)
+		{
+			return;
+		}
+
+		if (m_Colliders[denseIndex].IsSensor)
+		{
+			auto const sensorItr = std::find_if(m_Sensors.begin(), m_Sensors.end(), [id](Sensor const& sensor) { return sensor.ID == id; });
+			*sensorItr = std::move(m_Sensors.back());
+			m_Sensors.pop_back();
+		}
+
+		if (isInStaticBVH(m_Colliders[denseIndex]))
+		{
+			m_IsStaticBVHDirty = true;
+		}
+
+		destroyBroadPhaseProxy(m_Colliders[denseIndex].BroadPhaseProxyID);
+		if (m_Colliders[denseIndex].ContactPairProxyID != SweepAndPrune::NullProxy)
+		{
+			m_ContactPairs.DestroyProxy(m_Colliders[denseIndex].ContactPairProxyID);
+		}
+
+		// Move the last collider into the hole to keep the dense array packed.
+		std::uint32_t const lastDenseIndex = (std::uint32_t) m_Colliders.size() - 1;
+		if (denseIndex != lastDenseIndex)
+		{
+			std::uint32_t const movedSlotIndex = m_DenseToSlot[lastDenseIndex];
+			m_Colliders[denseIndex] = m_Colliders[lastDenseIndex];
+			m_DenseToSlot[denseIndex] = movedSlotIndex;
+			m_Slots[movedSlotIndex].DenseIndexOrNextFree = denseIndex;
+		}
+		m_Colliders.pop_back();
+		m_DenseToSlot.pop_back();
+		m_ColliderBounds.SwapAndPop(denseIndex);
+		m_ColliderBoxes.SwapAndPop(denseIndex);
+		for (InflatedAABBCache& cache : m_InflatedAABBCaches)
+		{
+			cache.Bounds.SwapAndPop(denseIndex);
+		}
+
+		Slot& slot = m_Slots[id.Index];
+		slot.IsInUse = false;
+		slot.DenseIndexOrNextFree = ColliderID::InvalidIndex;
+		slot.Generation++;
+		markSnapshotDirty(id.Index);
+
+		if (slot.Generation == 0)
 		{
+			// The generation has wrapped around, retire the slot for good
+			// so a stale handle can never match a future collider in this slot.
 			return;
 		}
 
-		m_AABBs.erase(m_AABBs.begin() + index);
+		// Append the slot to the end of the free queue.
+		if (m_FreeSlotTail == ColliderID::InvalidIndex)
+		{
+			m_FreeSlotHead = id.Index;
+		}
+		else
+		{
+			m_Slots[m_FreeSlotTail].DenseIndexOrNextFree = id.Index;
+		}
+		m_FreeSlotTail = id.Index;
 	}
 
 	bool ColliderManager::IsColliderRegistered(ColliderID id) const
 	{
-		int const index = binarySearchIndexOf(m_AABBs, id);
-		return index != -1;
+		return denseIndexOf(id) != ColliderID::InvalidIndex;
 	}
 
 	std::optional<Math::AABB> ColliderManager::GetAABB(ColliderID id)
 	{
-		int const index = binarySearchIndexOf(m_AABBs, id);
-		if (index == -1)
+		std::uint32_t const denseIndex = denseIndexOf(id);
+		if (denseIndex == ColliderID::InvalidIndex)
 		{
 			return {};
 		}
 
-		return m_AABBs[index].second;
+		return m_Colliders[denseIndex].AABB;
 	}
 
 	bool ColliderManager::SetAABB(ColliderID id, Math::AABB aabb)
 	{
-		int const index = binarySearchIndexOf(m_AABBs, id);
-		if (index == -1)
+		std::uint32_t const denseIndex = denseIndexOf(id);
+		if (denseIndex == ColliderID::InvalidIndex)
 		{
 			return false;
 		}
 
-		m_AABBs[index].second = aabb;
+		setColliderAABB(denseIndex, aabb);
+		moveBroadPhaseProxy(m_Colliders[denseIndex]);
 		return true;
 	}
 
-	std::vector<ColliderID> ColliderManager::OverlapAABB(Math::AABB aabb) const
+	void ColliderManager::BeginUpdate()
 	{
-		std::vector<ColliderID> overlappedIds;
+		m_IsUpdating = true;
+		m_PendingAABBUpdates.clear();
+	}
 
-		// TODO: improve the performance with AABB tree OR grid broad-phase
-		for (auto const& pair : m_AABBs)
+	void ColliderManager::SetAABBs(std::span<ColliderID const> ids, std::span<Math::AABB const> aabbs)
+	{
+		bool const isImplicitBatch = !m_IsUpdating;
+		if (isImplicitBatch)
 		{
-			bool const intersect = Math::AABBAABBIntersect2D(pair.second, aabb);
-			if (intersect)
-			{
-				overlappedIds.push_back(pair.first);
-			}
+			BeginUpdate();
 		}
 
-		return std::move(overlappedIds);
+		std::size_t const count = std::min(ids.size(), aabbs.size());
+		for (std::size_t i = 0; i < count; i++)
+		{
+			m_PendingAABBUpdates.push_back({.ID = ids[i], .AABB = aabbs[i], .DenseIndex = ColliderID::InvalidIndex});
+		}
+
+		if (isImplicitBatch)
+		{
+			EndUpdate();
+		}
 	}
 
-	std::vector<ColliderID> ColliderManager::OverlapCircle(glm::vec2 center, float radius) const
+	void ColliderManager::EndUpdate()
 	{
-		std::vector<ColliderID> overlappedIds;
+		if (!m_IsUpdating)
+		{
+			return;
+		}
+		m_IsUpdating = false;
 
-		// TODO: improve the performance with AABB tree OR grid broad-phase
-		for (auto const& pair : m_AABBs)
+		for (PendingAABBUpdate& update : m_PendingAABBUpdates)
 		{
-			bool const intersect = Math::AABBCircleIntersect(pair.second, center, radius);
-			if (intersect)
+			update.DenseIndex = denseIndexOf(update.ID);
+		}
+
+		// Walk the dense arrays forward. The sort is stable so the last update of a collider comes last among its duplicates,
+		// and the skipped colliders, with an invalid index, end up at the back.
+		std::stable_sort(m_PendingAABBUpdates.begin(), m_PendingAABBUpdates.end(), [](PendingAABBUpdate const& lhs, PendingAABBUpdate const& rhs)
+		{
+			return lhs.DenseIndex < rhs.DenseIndex;
+		});
+
+		m_MovedProxyIDs.clear();
+		m_MovedProxyAABBs.clear();
+		m_MovedProxyDisplacements.clear();
+		for (std::size_t i = 0; i < m_PendingAABBUpdates.size(); i++)
+		{
+			PendingAABBUpdate const& update = m_PendingAABBUpdates[i];
+			if (update.DenseIndex == ColliderID::InvalidIndex)
+			{
+				break;
+			}
+			if (i + 1 < m_PendingAABBUpdates.size() && m_PendingAABBUpdates[i + 1].DenseIndex == update.DenseIndex)
+			{
+				continue;
+			}
+
+			setColliderAABB(update.DenseIndex, update.AABB);
+
+			Collider const& collider = m_Colliders[update.DenseIndex];
+			if (collider.BroadPhaseProxyID != DynamicAABBTree::NullNode)
 			{
-				overlappedIds.push_back(pair.first);
+				m_MovedProxyIDs.push_back(collider.BroadPhaseProxyID);
+				m_MovedProxyAABBs.push_back(update.AABB);
+				m_MovedProxyDisplacements.push_back(predictedDisplacementOf(collider));
 			}
 		}
+		m_PendingAABBUpdates.clear();
 
-		return std::move(overlappedIds);
+		switch (m_BroadPhaseSettings.Type)
+		{
+			case BroadPhaseType::DynamicAABBTree:
+				m_AABBTree.MoveProxies(m_MovedProxyIDs, m_MovedProxyAABBs, m_MovedProxyDisplacements);
+				break;
+			case BroadPhaseType::SpatialHashGrid:
+				// The cells of a proxy are only touched when it changes cells, there is nothing to restore once per batch.
+				for (std::size_t i = 0; i < m_MovedProxyIDs.size(); i++)
+				{
+					m_SpatialHashGrid.MoveProxy(m_MovedProxyIDs[i], m_MovedProxyAABBs[i]);
+				}
+				break;
+			case BroadPhaseType::Linear:
+				break;
+		}
 	}
 
-	std::vector<RaycastHit2D> ColliderManager::RaycastAll(glm::vec2 start, glm::vec2 end) const
+	void ColliderManager::setColliderAABB(std::uint32_t denseIndex, Math::AABB const& aabb)
 	{
-		std::vector<RaycastHit2D> hits;
+		Collider& collider = m_Colliders[denseIndex];
+		collider.AABB = aabb;
+		collider.OrientedBox = OrientedBox2D::CreateFromAABB(aabb);
+		collider.IsOriented = false;
+		m_ColliderBounds.Set(denseIndex, aabb);
+		m_ColliderBoxes.Set(denseIndex, collider.OrientedBox);
+		for (InflatedAABBCache& cache : m_InflatedAABBCaches)
+		{
+			cache.Bounds.Set(denseIndex, inflateAABB(aabb, cache.Radius));
+		}
+		if (isInStaticBVH(collider))
+		{
+			m_IsStaticBVHDirty = true;
+		}
+		if (collider.ContactPairProxyID != SweepAndPrune::NullProxy)
+		{
+			m_ContactPairs.MoveProxy(collider.ContactPairProxyID, aabb);
+		}
+		markSnapshotDirty(m_DenseToSlot[denseIndex]);
+	}
 
-		glm::vec2 const direction = end - start;
-		float const maxDistance = glm::length(direction);
+	std::optional<OrientedBox2D> ColliderManager::GetOBB(ColliderID id) const
+	{
+		std::uint32_t const denseIndex = denseIndexOf(id);
+		if (denseIndex == ColliderID::InvalidIndex)
+		{
+			return {};
+		}
+
+		return m_Colliders[denseIndex].OrientedBox;
+	}
 
-		// TODO: improve the performance with AABB tree OR grid broad-phase
-		for (auto const& pair : m_AABBs)
+	bool ColliderManager::SetOBB(ColliderID id, OrientedBox2D const& box)
+	{
+		// The broad-phase, the caches and the contact pairs only see the bounds.
+		if (!SetAABB(id, box.GetBounds()))
 		{
-			Math::DynamicTestResult2D testResult;
-			bool const intersect = Math::RayAABBIntersect2D(start, direction, maxDistance, pair.second, testResult);
-			if (intersect)
-			{
-				hits.push_back(RaycastHit2D { .ColliderID = pair.first, .Time = testResult.HitTime, .Centroid = testResult.HitCentroid, .Point = testResult.HitPoint, .Normal = testResult.HitNormal });
-			}
+			return false;
 		}
 
-		std::sort(hits.begin(), hits.end(), [](RaycastHit2D const& hitA, RaycastHit2D const& hitB) { return hitA.Time < hitB.Time; });
+		std::uint32_t const denseIndex = denseIndexOf(id);
+		m_Colliders[denseIndex].OrientedBox = box;
+		m_Colliders[denseIndex].IsOriented = true;
+		m_ColliderBoxes.Set(denseIndex, box);
+		return true;
+	}
 
-		return std::move(hits);
+	std::optional<CollisionFilter> ColliderManager::GetCollisionFilter(ColliderID id) const
+	{
+		std::uint32_t const denseIndex = denseIndexOf(id);
+		if (denseIndex == ColliderID::InvalidIndex)
+		{
+			return {};
+		}
 
+		return m_Colliders[denseIndex].Filter;
 	}
 
-	std::vector<RaycastHit2D> ColliderManager::CircleCastAll(glm::vec2 center, float radius, glm::vec2 direction) const
+	bool ColliderManager::SetCollisionFilter(ColliderID id, CollisionFilter filter)
 	{
-		std::vector<RaycastHit2D> hits;
+		std::uint32_t const denseIndex = denseIndexOf(id);
+		if (denseIndex == ColliderID::InvalidIndex)
+		{
+			return false;
+		}
 
-		// TODO: improve the performance with AABB tree OR grid broad-phase
-		for (auto const& pair : m_AABBs)
+		Collider& collider = m_Colliders[denseIndex];
+		bool const isCategoryChanged = collider.Filter.CategoryBits != filter.CategoryBits;
+		collider.Filter = filter;
+		if (isCategoryChanged)
 		{
-			Math::DynamicTestResult2D testResult;
-			bool const intersect = Math::MovingCircleAABBIntersect(center, radius, direction, pair.second, testResult);
-			if (intersect)
+			setBroadPhaseProxyCategoryBits(collider.BroadPhaseProxyID, filter.CategoryBits);
+			if (isInStaticBVH(collider))
 			{
-				hits.push_back(RaycastHit2D { .ColliderID = pair.first, .Time = testResult.HitTime, .Centroid = testResult.HitCentroid, .Point = testResult.HitPoint, .Normal = testResult.HitNormal });
+				m_IsStaticBVHDirty = true;
 			}
 		}
+		if (collider.ContactPairProxyID != SweepAndPrune::NullProxy)
+		{
+			m_ContactPairs.SetFilterBits(collider.ContactPairProxyID, filter.CategoryBits, filter.MaskBits);
+		}
+		markSnapshotDirty(id.Index);
+		return true;
+	}
 
-		std::sort(hits.begin(), hits.end(), [](RaycastHit2D const& hitA, RaycastHit2D const& hitB) { return hitA.Time < hitB.Time; });
+	std::optional<ColliderUserData> ColliderManager::GetUserData(ColliderID id) const
+	{
+		std::uint32_t const denseIndex = denseIndexOf(id);
+		if (denseIndex == ColliderID::InvalidIndex)
+		{
+			return {};
+		}
 
-		return std::move(hits);
+		return m_Colliders[denseIndex].UserData;
+	}
+
+	std::optional<glm::vec2> ColliderManager::ClosestPoint(ColliderID id, glm::vec2 point) const
+	{
+		std::uint32_t const denseIndex = denseIndexOf(id);
+		if (denseIndex == ColliderID::InvalidIndex)
+		{
+			return {};
+		}
+
+		return closestPointOf(m_Colliders[denseIndex], point);
+	}
+
+	bool ColliderManager::SetUserData(ColliderID id, ColliderUserData userData)
+	{
+		std::uint32_t const denseIndex = denseIndexOf(id);
+		if (denseIndex == ColliderID::InvalidIndex)
+		{
+			return false;
+		}
+
+		m_Colliders[denseIndex].UserData = userData;
+		markSnapshotDirty(id.Index);
+		return true;
+	}
+
+	std::optional<glm::vec2> ColliderManager::GetVelocity(ColliderID id) const
+	{
+		std::uint32_t const denseIndex = denseIndexOf(id);
+		if (denseIndex == ColliderID::InvalidIndex)
+		{
+			return {};
+		}
+
+		return m_Colliders[denseIndex].Velocity;
+	}
+
+	bool ColliderManager::SetVelocity(ColliderID id, glm::vec2 velocity)
+	{
+		std::uint32_t const denseIndex = denseIndexOf(id);
+		if (denseIndex == ColliderID::InvalidIndex)
+		{
+			return false;
+		}
+
+		// The leaf is stretched along the new velocity the next time the collider leaves it.
+		m_Colliders[denseIndex].Velocity = velocity;
+		markSnapshotDirty(id.Index);
+		return true;
 	}
 
-	void ColliderManager::DrawGizmos() const
+	bool ColliderManager::IsSensor(ColliderID id) const
 	{
-		for (auto const& pair : m_AABBs)
+		std::uint32_t const denseIndex = denseIndexOf(id);
+		if (denseIndex == ColliderID::InvalidIndex)
 		{
-			DebugDraw::AABB(pair.second.Min, pair.second.Max, Color::Blue);
+			return false;
 		}
+
+		return m_Colliders[denseIndex].IsSensor;
 	}
 
-	void ColliderManager::DrawImGui()
+	void ColliderManager::UpdateContactPairs()
 	{
-		if (ImGui::Begin("Collider Manager"))
+		m_ContactPairs.UpdatePairs();
+
+		m_ContactEvents.clear();
+		for (SweepAndPrune::PairEvent const& pairEvent : m_ContactPairs.GetPairEvents())
 		{
-			for (auto& aabbPair : m_AABBs)
+			m_ContactEvents.push_back(ContactEvent
 			{
-				std::string const label = "AABB " + std::to_string(aabbPair.first);
-				ImGuiUtil::DrawAABBControl(label, aabbPair.second);
-			}
+				.Type = pairEvent.IsBegin? ContactEventType::Begin : ContactEventType::End,
+				.ColliderA = colliderIDOfContactUserData(pairEvent.UserDataA),
+				.ColliderB = colliderIDOfContactUserData(pairEvent.UserDataB)
+			});
+		}
+	}
+
+	void ColliderManager::UpdateSensors()
+	{
+		m_SensorEvents.clear();
+		for (Sensor& sensor : m_Sensors)
+		{
+			updateSensor(sensor);
+		}
+	}
+
+	void ColliderManager::RegisterCircleCastRadius(float radius)
+	{
+		if (tryGetInflatedAABBCache(radius) != nullptr)
+		{
+			return;
 		}
 
-		ImGui::End();
+		InflatedAABBCache& cache = m_InflatedAABBCaches.emplace_back();
+		cache.Radius = radius;
+		for (Collider const& collider : m_Colliders)
+		{
+			cache.Bounds.PushBack(inflateAABB(collider.AABB, radius));
+		}
+	}
+
+	void ColliderManager::UnregisterCircleCastRadius(float radius)
+	{
+		std::erase_if(m_InflatedAABBCaches, [radius](InflatedAABBCache const& cache) { return cache.Radius == radius; });
+	}
+
+	std::vector<ColliderID> ColliderManager::OverlapAABB(Math::AABB aabb, CollisionFilter filter) const
+	{
+		std::vector<ColliderID> overlappedIds;
+		OverlapAABB(aabb, overlappedIds, filter);
+		return std::move(overlappedIds);
+	}
+
+	std::vector<ColliderID> ColliderManager::OverlapCircle(glm::vec2 center, float radius, CollisionFilter filter) const
+	{
+		std::vector<ColliderID> overlappedIds;
+		OverlapCircle(center, radius, overlappedIds, filter);
+		return std::move(overlappedIds);
+	}
+
+	std::vector<RaycastHit2D> ColliderManager::RaycastAll(glm::vec2 start, glm::vec2 end, CollisionFilter filter) const
+	{
+		std::vector<RaycastHit2D> hits;
+		RaycastAll(start, end, hits, filter);
+		return std::move(hits);
+	}
+
+	std::vector<RaycastHit2D> ColliderManager::CircleCastAll(glm::vec2 center, float radius, glm::vec2 direction, CollisionFilter filter) const
+	{
+		std::vector<RaycastHit2D> hits;
+		CircleCastAll(center, radius, direction, hits, filter);
+		return std::move(hits);
+	}
+
+	std::vector<RaycastHit2D> ColliderManager::SweepAABB(Math::AABB aabb, glm::vec2 delta, CollisionFilter filter) const
+	{
+		std::vector<RaycastHit2D> hits;
+		SweepAABB(aabb, delta, hits, filter);
+		return std::move(hits);
+	}
+
+	std::vector<RaycastHit2D> ColliderManager::BoxCastAll(OrientedBox2D const& box, glm::vec2 direction, CollisionFilter filter) const
+	{
+		std::vector<RaycastHit2D> hits;
+		BoxCastAll(box, direction, hits, filter);
+		return std::move(hits);
+	}
+
+	std::optional<RaycastHit2D> ColliderManager::Raycast(glm::vec2 start, glm::vec2 end, CollisionFilter filter) const
+	{
+		std::optional<RaycastHit2D> nearestHit;
+
+		glm::vec2 const direction = end - start;
+		float const maxDistance = glm::length(direction);
+
+		castBroadPhase(start, direction, {0, 0}, filter, [&](ColliderID id, Collider const& collider, float maxFraction)
+		{
+			RaycastHit2D hit;
+			if (!raycastCollider(id, collider, start, direction, maxDistance, hit))
+			{
+				return maxFraction;
+			}
+
+			if (nearestHit.has_value() && nearestHit->Time <= hit.Time)
+			{
+				return maxFraction;
+			}
+
+			nearestHit = hit;
+			return clipFractionOf(hit, start, direction);
+		});
+
+		return nearestHit;
+	}
+
+	std::optional<RaycastHit2D> ColliderManager::CircleCast(glm::vec2 center, float radius, glm::vec2 direction, CollisionFilter filter) const
+	{
+		return nearestCircleCast(center, radius, direction, filter, {});
 	}
 
-	int ColliderManager::binarySearchIndexOf(std::vector<std::pair<ColliderID, Math::AABB>> const& collection, ColliderID id) const
+	std::optional<RaycastHit2D> ColliderManager::nearestCircleCast(glm::vec2 center, float radius, glm::vec2 direction, CollisionFilter const& filter,
+																   std::span<ColliderID const> ignoredIDs) const
 	{
-		int left = 0;
-		int right = m_AABBs.size() - 1;
-		while (left <= right)
+		std::optional<RaycastHit2D> nearestHit;
+
+		BroadPhaseSegment const segment = BroadPhaseSegment::Create(center, direction);
+		InflatedAABBCache const* pInflatedAABBCache = tryGetInflatedAABBCache(radius);
+
+		castBroadPhase(center, direction, {radius, radius}, filter, [&](ColliderID id, Collider const& collider, float maxFraction)
 		{
-			int const mid = left + (right - left) / 2;
-			ColliderID const midId = m_AABBs[mid].first;
+			RaycastHit2D hit;
+			if (std::find(ignoredIDs.begin(), ignoredIDs.end(), id) != ignoredIDs.end() ||
+				!circleCastCollider(id, collider, radius, segment, pInflatedAABBCache, hit))
+			{
+				return maxFraction;
+			}
 
-			if (midId == id)
+			if (nearestHit.has_value() && nearestHit->Time <= hit.Time)
 			{
-				return mid;
+				return maxFraction;
 			}
 
-			if (midId < id)
+			nearestHit = hit;
+			return clipFractionOf(hit, center, direction);
+		});
+
+		return nearestHit;
+	}
+
+	std::optional<RaycastHit2D> ColliderManager::BoxCast(OrientedBox2D const& box, glm::vec2 direction, CollisionFilter filter) const
+	{
+		std::optional<RaycastHit2D> nearestHit;
+
+		castOrientedBoxBroadPhase(box, direction, filter, [&](ColliderID id, Collider const& collider, float maxFraction)
+		{
+			RaycastHit2D hit;
+			if (!boxCastCollider(id, collider, box, direction, hit))
 			{
-				left = mid + 1;
-				continue;
+				return maxFraction;
 			}
 
-			if (midId > id)
+			if (nearestHit.has_value() && nearestHit->Time <= hit.Time)
 			{
-				right = mid - 1;
-				continue;
+				return maxFraction;
 			}
+
+			nearestHit = hit;
+			return clipFractionOf(hit, box.Center, direction);
+		});
+
+		return nearestHit;
+	}
+
+	void ColliderManager::RaycastPacket(glm::vec2 start, std::span<glm::vec2 const> ends, std::span<std::optional<RaycastHit2D>> outHits, CollisionFilter filter) const
+	{
+		for (std::size_t firstRay = 0; firstRay < ends.size(); firstRay += RayPacket::MaxRayCount)
+		{
+			std::size_t const rayCount = std::min<std::size_t>(RayPacket::MaxRayCount, ends.size() - firstRay);
+			raycastPacket(start, ends.subspan(firstRay, rayCount), outHits.subspan(firstRay, rayCount), filter);
 		}
+	}
 
-		return -1;
+	void ColliderManager::OverlapAABB(Math::AABB aabb, std::vector<ColliderID>& results, CollisionFilter filter) const
+	{
+		results.clear();
+		OverlapAABB(aabb, [&results](ColliderID id) { results.push_back(id); return true; }, filter);
+	}
+
+	void ColliderManager::OverlapCircle(glm::vec2 center, float radius, std::vector<ColliderID>& results, CollisionFilter filter) const
+	{
+		results.clear();
+		OverlapCircle(center, radius, [&results](ColliderID id) { results.push_back(id); return true; }, filter);
+	}
+
+	void ColliderManager::RaycastAll(glm::vec2 start, glm::vec2 end, std::vector<RaycastHit2D>& results, CollisionFilter filter) const
+	{
+		results.clear();
+		RaycastAll(start, end, [&results](RaycastHit2D const& hit) { results.push_back(hit); return true; }, filter);
+		std::sort(results.begin(), results.end(), [](RaycastHit2D const& hitA, RaycastHit2D const& hitB) { return hitA.Time < hitB.Time; });
+	}
+
+	void ColliderManager::CircleCastAll(glm::vec2 center, float radius, glm::vec2 direction, std::vector<RaycastHit2D>& results, CollisionFilter filter) const
+	{
+		results.clear();
+		CircleCastAll(center, radius, direction, [&results](RaycastHit2D const& hit) { results.push_back(hit); return true; }, filter);
+		std::sort(results.begin(), results.end(), [](RaycastHit2D const& hitA, RaycastHit2D const& hitB) { return hitA.Time < hitB.Time; });
+	}
+
+	void ColliderManager::SweepAABB(Math::AABB aabb, glm::vec2 delta, std::vector<RaycastHit2D>& results, CollisionFilter filter) const
+	{
+		results.clear();
+		SweepAABB(aabb, delta, [&results](RaycastHit2D const& hit) { results.push_back(hit); return true; }, filter);
+		std::sort(results.begin(), results.end(), [](RaycastHit2D const& hitA, RaycastHit2D const& hitB) { return hitA.Time < hitB.Time; });
+	}
+
+	void ColliderManager::BoxCastAll(OrientedBox2D const& box, glm::vec2 direction, std::vector<RaycastHit2D>& results, CollisionFilter filter) const
+	{
+		results.clear();
+		BoxCastAll(box, direction, [&results](RaycastHit2D const& hit) { results.push_back(hit); return true; }, filter);
+		std::sort(results.begin(), results.end(), [](RaycastHit2D const& hitA, RaycastHit2D const& hitB) { return hitA.Time < hitB.Time; });
+	}
+
+	std::size_t ColliderManager::OverlapAABB(Math::AABB aabb, std::span<ColliderID> results, CollisionFilter filter) const
+	{
+		std::size_t count = 0;
+		if (results.empty())
+		{
+			return count;
+		}
+
+		OverlapAABB(aabb, [&](ColliderID id)
+		{
+			results[count] = id;
+			count++;
+			return count < results.size();
+		}, filter);
+		return count;
+	}
+
+	std::size_t ColliderManager::OverlapCircle(glm::vec2 center, float radius, std::span<ColliderID> results, CollisionFilter filter) const
+	{
+		std::size_t count = 0;
+		if (results.empty())
+		{
+			return count;
+		}
+
+		OverlapCircle(center, radius, [&](ColliderID id)
+		{
+			results[count] = id;
+			count++;
+			return count < results.size();
+		}, filter);
+		return count;
+	}
+
+	std::size_t ColliderManager::RaycastAll(glm::vec2 start, glm::vec2 end, std::span<RaycastHit2D> results, CollisionFilter filter) const
+	{
+		std::size_t count = 0;
+		if (results.empty())
+		{
+			return count;
+		}
+
+		RaycastAll(start, end, [&](RaycastHit2D const& hit) { keepNearestHit(results, count, hit); return true; }, filter);
+		std::sort(results.begin(), results.begin() + count, [](RaycastHit2D const& hitA, RaycastHit2D const& hitB) { return hitA.Time < hitB.Time; });
+		return count;
+	}
+
+	std::size_t ColliderManager::CircleCastAll(glm::vec2 center, float radius, glm::vec2 direction, std::span<RaycastHit2D> results, CollisionFilter filter) const
+	{
+		std::size_t count = 0;
+		if (results.empty())
+		{
+			return count;
+		}
+
+		CircleCastAll(center, radius, direction, [&](RaycastHit2D const& hit) { keepNearestHit(results, count, hit); return true; }, filter);
+		std::sort(results.begin(), results.begin() + count, [](RaycastHit2D const& hitA, RaycastHit2D const& hitB) { return hitA.Time < hitB.Time; });
+		return count;
+	}
+
+	std::size_t ColliderManager::SweepAABB(Math::AABB aabb, glm::vec2 delta, std::span<RaycastHit2D> results, CollisionFilter filter) const
+	{
+		std::size_t count = 0;
+		if (results.empty())
+		{
+			return count;
+		}
+
+		SweepAABB(aabb, delta, [&](RaycastHit2D const& hit) { keepNearestHit(results, count, hit); return true; }, filter);
+		std::sort(results.begin(), results.begin() + count, [](RaycastHit2D const& hitA, RaycastHit2D const& hitB) { return hitA.Time < hitB.Time; });
+		return count;
+	}
+
+	std::size_t ColliderManager::BoxCastAll(OrientedBox2D const& box, glm::vec2 direction, std::span<RaycastHit2D> results, CollisionFilter filter) const
+	{
+		std::size_t count = 0;
+		if (results.empty())
+		{
+			return count;
+		}
+
+		BoxCastAll(box, direction, [&](RaycastHit2D const& hit) { keepNearestHit(results, count, hit); return true; }, filter);
+		std::sort(results.begin(), results.begin() + count, [](RaycastHit2D const& hitA, RaycastHit2D const& hitB) { return hitA.Time < hitB.Time; });
+		return count;
+	}
+
+	std::optional<ColliderDistance2D> ColliderManager::NearestCollider(glm::vec2 point, float maxDistance, CollisionFilter filter) const
+	{
+		std::optional<ColliderDistance2D> nearest;
+		nearestBroadPhase(point, maxDistance * maxDistance, filter, [&](ColliderID id, Collider const& collider, float maxDistanceSquared)
+		{
+			glm::vec2 const closestPoint = closestPointOf(collider, point);
+			float const distanceSquared = glm::dot(closestPoint - point, closestPoint - point);
+			if (distanceSquared > maxDistanceSquared || (nearest.has_value() && nearest->Distance * nearest->Distance <= distanceSquared))
+			{
+				return maxDistanceSquared;
+			}
+
+			nearest = ColliderDistance2D {.ColliderID = id, .UserData = collider.UserData, .Distance = glm::sqrt(distanceSquared), .Point = closestPoint};
+			return distanceSquared;
+		});
+
+		return nearest;
+	}
+
+	std::vector<ColliderDistance2D> ColliderManager::KNearest(glm::vec2 point, std::size_t k, float maxDistance, CollisionFilter filter) const
+	{
+		std::vector<ColliderDistance2D> results(k);
+		results.resize(KNearest(point, results, maxDistance, filter));
+		return std::move(results);
+	}
+
+	std::size_t ColliderManager::KNearest(glm::vec2 point, std::span<ColliderDistance2D> results, float maxDistance, CollisionFilter filter) const
+	{
+		std::size_t count = 0;
+		if (results.empty())
+		{
+			return count;
+		}
+
+		// The results are kept as a max heap on the distance until the search is over, the farthest result is the bound once the span is full.
+		auto isNearer = [](ColliderDistance2D const& resultA, ColliderDistance2D const& resultB) { return resultA.Distance < resultB.Distance; };
+		nearestBroadPhase(point, maxDistance * maxDistance, filter, [&](ColliderID id, Collider const& collider, float maxDistanceSquared)
+		{
+			glm::vec2 const closestPoint = closestPointOf(collider, point);
+			float const distanceSquared = glm::dot(closestPoint - point, closestPoint - point);
+			if (distanceSquared > maxDistanceSquared)
+			{
+				return maxDistanceSquared;
+			}
+
+			ColliderDistance2D const result {.ColliderID = id, .UserData = collider.UserData, .Distance = glm::sqrt(distanceSquared), .Point = closestPoint};
+			if (count < results.size())
+			{
+				results[count++] = result;
+				std::push_heap(results.begin(), results.begin() + count, isNearer);
+			}
+			else if (result.Distance < results.front().Distance)
+			{
+				std::pop_heap(results.begin(), results.end(), isNearer);
+				results.back() = result;
+				std::push_heap(results.begin(), results.end(), isNearer);
+			}
+
+			if (count < results.size())
+			{
+				return maxDistanceSquared;
+			}
+			return results.front().Distance * results.front().Distance;
+		});
+
+		std::sort_heap(results.begin(), results.begin() + count, isNearer);
+		return count;
+	}
+
+	std::shared_ptr<ColliderManager::Snapshot const> ColliderManager::PublishSnapshot()
+	{
+		std::uint32_t const snapshotIndex = (std::uint32_t) (m_SnapshotEpoch % m_Snapshots.size());
+		std::shared_ptr<Snapshot>& snapshot = m_Snapshots[snapshotIndex];
+		std::vector<std::uint32_t>& dirtySlots = m_SnapshotDirtySlots[snapshotIndex];
+
+		// This snapshot isn't the published one, so readers can't take new references to it, only release theirs.
+		bool const isRecyclable = snapshot != nullptr && snapshot.use_count() == 1;
+		if (isRecyclable)
+		{
+			// Pairs with the release of the last reader, its reads must be done before the snapshot is written.
+			std::atomic_thread_fence(std::memory_order_acquire);
+			snapshot->m_Colliders.resize(m_Slots.size());
+			snapshot->m_Generations.resize(m_Slots.size(), 0);
+			for (std::uint32_t const slotIndex : dirtySlots)
+			{
+				copySlotToSnapshot(*snapshot, slotIndex);
+			}
+		}
+		else
+		{
+			// The first publish, or a reader still holds the snapshot: leave it to the reader and copy everything into a new one.
+			snapshot = std::shared_ptr<Snapshot>(new Snapshot());
+			snapshot->m_Colliders.resize(m_Slots.size());
+			snapshot->m_Generations.resize(m_Slots.size(), 0);
+			for (std::uint32_t slotIndex = 0; slotIndex < m_Slots.size(); slotIndex++)
+			{
+				copySlotToSnapshot(*snapshot, slotIndex);
+			}
+		}
+
+		std::uint8_t const dirtyBit = 1u << snapshotIndex;
+		for (std::uint32_t const slotIndex : dirtySlots)
+		{
+			m_SnapshotDirtyBits[slotIndex] &= ~dirtyBit;
+		}
+		dirtySlots.clear();
+
+		m_SnapshotEpoch++;
+		snapshot->m_Epoch = m_SnapshotEpoch;
+		snapshot->m_ColliderCount = m_Colliders.size();
+
+		std::lock_guard const lock(m_PublishedSnapshotMutex);
+		m_PublishedSnapshot = snapshot;
+		return m_PublishedSnapshot;
+	}
+
+	std::shared_ptr<ColliderManager::Snapshot const> ColliderManager::GetSnapshot() const
+	{
+		std::lock_guard const lock(m_PublishedSnapshotMutex);
+		return m_PublishedSnapshot;
+	}
+
+	void ColliderManager::markSnapshotDirty(std::uint32_t slotIndex)
+	{
+		if (m_SnapshotEpoch == 0)
+		{
+			// Nothing to keep up to date, the first publish copies every collider.
+			return;
+		}
+
+		if (slotIndex >= m_SnapshotDirtyBits.size())
+		{
+			m_SnapshotDirtyBits.resize(m_Slots.size(), 0);
+		}
+
+		for (std::uint32_t snapshotIndex = 0; snapshotIndex < m_SnapshotDirtySlots.size(); snapshotIndex++)
+		{
+			std::uint8_t const dirtyBit = 1u << snapshotIndex;
+			if ((m_SnapshotDirtyBits[slotIndex] & dirtyBit) == 0)
+			{
+				m_SnapshotDirtyBits[slotIndex] |= dirtyBit;
+				m_SnapshotDirtySlots[snapshotIndex].push_back(slotIndex);
+			}
+		}
+	}
+
+	void ColliderManager::copySlotToSnapshot(Snapshot& snapshot, std::uint32_t slotIndex) const
+	{
+		Slot const& slot = m_Slots[slotIndex];
+		if (!slot.IsInUse)
+		{
+			snapshot.m_Generations[slotIndex] = 0;
+			return;
+		}
+
+		snapshot.m_Colliders[slotIndex] = m_Colliders[slot.DenseIndexOrNextFree];
+		snapshot.m_Generations[slotIndex] = slot.Generation;
+	}
+
+	void ColliderManager::raycastPacket(glm::vec2 start, std::span<glm::vec2 const> ends, std::span<std::optional<RaycastHit2D>> outHits, CollisionFilter const& filter) const
+	{
+		RayPacket packet;
+		packet.Start = start;
+
+		std::array<glm::vec2, RayPacket::MaxRayCount> displacements;
+		std::array<float, RayPacket::MaxRayCount> maxDistances;
+		glm::vec2 packetMin = start;
+		glm::vec2 packetMax = start;
+
+		for (std::uint32_t ray = 0; ray < ends.size(); ray++)
+		{
+			displacements[ray] = ends[ray] - start;
+			maxDistances[ray] = glm::length(displacements[ray]);
+			packet.AddRay(displacements[ray]);
+
+			packetMin = glm::min(packetMin, ends[ray]);
+			packetMax = glm::max(packetMax, ends[ray]);
+			outHits[ray].reset();
+		}
+
+		auto testCollider = [&](ColliderID id, Collider const& collider)
+		{
+			std::uint32_t rayMask = CollisionKernels::RayPacketBox(packet, collider.AABB.Min, collider.AABB.Max);
+			while (rayMask != 0)
+			{
+				std::uint32_t const ray = (std::uint32_t) std::countr_zero(rayMask);
+				rayMask &= rayMask - 1;
+
+				RaycastHit2D hit;
+				if (!raycastCollider(id, collider, start, displacements[ray], maxDistances[ray], hit))
+				{
+					continue;
+				}
+
+				if (outHits[ray].has_value() && outHits[ray]->Time <= hit.Time)
+				{
+					continue;
+				}
+
+				// Clip the ray so farther boxes and tree nodes are culled for this ray.
+				outHits[ray] = hit;
+				packet.MaxFraction[ray] = clipFractionOf(hit, start, displacements[ray]);
+			}
+			return true;
+		};
+
+		if (m_BroadPhaseSettings.Type == BroadPhaseType::DynamicAABBTree)
+		{
+			// Descend into a node as long as one of the rays still reaches it.
+			m_AABBTree.Traverse
+			(
+				[&packet](glm::vec2 nodeMin, glm::vec2 nodeMax) { return CollisionKernels::RayPacketBox(packet, nodeMin, nodeMax) != 0; },
+				[&](std::int32_t slotIndex)
+				{
+					Collider const& collider = m_Colliders[m_Slots[slotIndex].DenseIndexOrNextFree];
+					return !isVisibleToQuery(collider, filter) || testCollider(idOfSlot(slotIndex), collider);
+				},
+				filter.MaskBits
+			);
+
+			bakeStaticCollidersIfDirty();
+			m_StaticBVH.Traverse
+			(
+				[&packet](glm::vec2 nodeMin, glm::vec2 nodeMax) { return CollisionKernels::RayPacketBox(packet, nodeMin, nodeMax) != 0; },
+				[&](std::int32_t slotIndex)
+				{
+					Collider const& collider = m_Colliders[m_Slots[slotIndex].DenseIndexOrNextFree];
+					return !isVisibleToQuery(collider, filter) || testCollider(idOfSlot(slotIndex), collider);
+				},
+				filter.MaskBits
+			);
+			return;
+		}
+
+		// The grid and the linear broad-phase gather the candidates within the bounds of the whole fan.
+		queryBroadPhase(packetMin, packetMax, filter, testCollider);
+	}
+
+	bool ColliderManager::sweepAABBCollider(ColliderID id, Collider const& collider, glm::vec2 halfExtents, BroadPhaseSegment const& segment, RaycastHit2D& outHit)
+	{
+		if (collider.IsOriented)
+		{
+			OrientedBox2D const box {.Center = segment.Start, .HalfExtents = halfExtents, .AxisX = {1, 0}};
+			return boxCastCollider(id, collider, box, segment.Displacement, outHit);
+		}
+
+		glm::vec2 const boxMin {collider.AABB.Min.x, collider.AABB.Min.y};
+		glm::vec2 const boxMax {collider.AABB.Max.x, collider.AABB.Max.y};
+		glm::vec2 const inflatedMin = boxMin - halfExtents;
+		glm::vec2 const inflatedMax = boxMax + halfExtents;
+
+		// Same slab test as the circle cast, without the rounded corners: the swept box touches the collider with a face.
+		float tMin = 0.0f;
+		float tMax = 1.0f;
+		glm::vec2 entryNormal {0, 0};
+
+		for (int axis = 0; axis < 2; axis++)
+		{
+			bool const isParallel = axis == 0? segment.IsParallelX : segment.IsParallelY;
+			if (isParallel)
+			{
+				if (segment.Start[axis] < inflatedMin[axis] || segment.Start[axis] > inflatedMax[axis])
+				{
+					return false;
+				}
+				continue;
+			}
+
+			float t1 = (inflatedMin[axis] - segment.Start[axis]) * segment.InverseDisplacement[axis];
+			float t2 = (inflatedMax[axis] - segment.Start[axis]) * segment.InverseDisplacement[axis];
+			float normalSign = -1.0f;
+			if (t1 > t2)
+			{
+				std::swap(t1, t2);
+				normalSign = 1.0f;
+			}
+
+			if (t1 > tMin)
+			{
+				tMin = t1;
+				entryNormal = {0, 0};
+				entryNormal[axis] = normalSign;
+			}
+
+			tMax = glm::min(tMax, t2);
+			if (tMin > tMax)
+			{
+				return false;
+			}
+		}
+
+		glm::vec2 const centroid = segment.Start + segment.Displacement * tMin;
+		outHit = RaycastHit2D
+		{
+			.ColliderID = id,
+			.UserData = collider.UserData,
+			.Time = tMin,
+			.Centroid = centroid,
+			.Point = glm::clamp(centroid, boxMin, boxMax),
+			.Normal = entryNormal
+		};
+		return true;
+	}
+
+	bool ColliderManager::circleCastInflatedCollider(ColliderID id, Collider const& collider, glm::vec2 inflatedMin, glm::vec2 inflatedMax,
+													 float radius, BroadPhaseSegment const& segment, RaycastHit2D& outHit)
+	{
+		// Slab test of the circle center against the inflated box, remember the axis the center enters from.
+		float tMin = 0.0f;
+		float tMax = 1.0f;
+		glm::vec2 entryNormal {0, 0};
+
+		for (int axis = 0; axis < 2; axis++)
+		{
+			bool const isParallel = axis == 0? segment.IsParallelX : segment.IsParallelY;
+			if (isParallel)
+			{
+				if (segment.Start[axis] < inflatedMin[axis] || segment.Start[axis] > inflatedMax[axis])
+				{
+					return false;
+				}
+				continue;
+			}
+
+			float t1 = (inflatedMin[axis] - segment.Start[axis]) * segment.InverseDisplacement[axis];
+			float t2 = (inflatedMax[axis] - segment.Start[axis]) * segment.InverseDisplacement[axis];
+			float normalSign = -1.0f;
+			if (t1 > t2)
+			{
+				std::swap(t1, t2);
+				normalSign = 1.0f;
+			}
+
+			if (t1 > tMin)
+			{
+				tMin = t1;
+				entryNormal = {0, 0};
+				entryNormal[axis] = normalSign;
+			}
+
+			tMax = glm::min(tMax, t2);
+			if (tMin > tMax)
+			{
+				return false;
+			}
+		}
+
+		glm::vec2 const boxMin {collider.AABB.Min.x, collider.AABB.Min.y};
+		glm::vec2 const boxMax {collider.AABB.Max.x, collider.AABB.Max.y};
+		glm::vec2 centroid = segment.Start + segment.Displacement * tMin;
+
+		// Outside of the box on both axes, the center is in a corner region where the inflated box is rounded.
+		bool const isOutsideX = centroid.x < boxMin.x || centroid.x > boxMax.x;
+		bool const isOutsideY = centroid.y < boxMin.y || centroid.y > boxMax.y;
+		if (isOutsideX && isOutsideY)
+		{
+			glm::vec2 const corner {centroid.x > boxMax.x? boxMax.x : boxMin.x, centroid.y > boxMax.y? boxMax.y : boxMin.y};
+
+			// Solve |start + displacement * t - corner| = radius for the smallest t.
+			glm::vec2 const cornerToStart = segment.Start - corner;
+			float const a = glm::dot(segment.Displacement, segment.Displacement);
+			float const b = glm::dot(cornerToStart, segment.Displacement);
+			float const c = glm::dot(cornerToStart, cornerToStart) - radius * radius;
+			if (c > 0.0f && b >= 0.0f)
+			{
+				// Starting outside of the corner circle and moving away from it.
+				return false;
+			}
+
+			float const discriminant = b * b - a * c;
+			if (discriminant < 0.0f)
+			{
+				return false;
+			}
+
+			float const cornerTime = c <= 0.0f? 0.0f : (-b - glm::sqrt(discriminant)) / a;
+			if (cornerTime > 1.0f)
+			{
+				return false;
+			}
+
+			tMin = cornerTime;
+			centroid = segment.Start + segment.Displacement * tMin;
+		}
+
+		glm::vec2 const closestPoint = glm::clamp(centroid, boxMin, boxMax);
+		glm::vec2 const closestPointToCentroid = centroid - closestPoint;
+		bool const isTouchingSurface = glm::dot(closestPointToCentroid, closestPointToCentroid) > 0.0f;
+
+		outHit = RaycastHit2D
+		{
+			.ColliderID = id,
+			.UserData = collider.UserData,
+			.Time = tMin,
+			.Centroid = centroid,
+			.Point = closestPoint,
+			.Normal = isTouchingSurface? glm::normalize(closestPointToCentroid) : entryNormal
+		};
+		return true;
+	}
+
+	void ColliderManager::keepNearestHit(std::span<RaycastHit2D> results, std::size_t& count, RaycastHit2D const& hit)
+	{
+		if (count < results.size())
+		{
+			results[count] = hit;
+			count++;
+			return;
+		}
+
+		auto const farthestItr = std::max_element(results.begin(), results.end(), [](RaycastHit2D const& hitA, RaycastHit2D const& hitB) { return hitA.Time < hitB.Time; });
+		if (hit.Time < farthestItr->Time)
+		{
+			*farthestItr = hit;
+		}
+	}
+
+	void ColliderManager::bakeStaticCollidersIfDirty() const
+	{
+		if (!m_IsStaticBVHDirty.load(std::memory_order_acquire))
+		{
+			return;
+		}
+
+		std::scoped_lock const lock(m_StaticBVHMutex);
+		if (!m_IsStaticBVHDirty.load(std::memory_order_relaxed))
+		{
+			// Another thread has baked the colliders while this one was waiting for the lock.
+			return;
+		}
+
+		std::vector<StaticBVH::Primitive> primitives;
+		for (std::uint32_t denseIndex = 0; denseIndex < m_Colliders.size(); denseIndex++)
+		{
+			Collider const& collider = m_Colliders[denseIndex];
+			if (!isInStaticBVH(collider))
+			{
+				continue;
+			}
+
+			primitives.push_back(StaticBVH::Primitive
+			{
+				.Min = collider.AABB.Min,
+				.Max = collider.AABB.Max,
+				.UserData = (std::int32_t) m_DenseToSlot[denseIndex],
+				.CategoryBits = collider.Filter.CategoryBits
+			});
+		}
+
+		m_StaticBVH.Build(primitives);
+		m_IsStaticBVHDirty.store(false, std::memory_order_release);
+	}
+
+	void ColliderManager::updateSensor(Sensor& sensor)
+	{
+		Collider const& sensorCollider = m_Colliders[denseIndexOf(sensor.ID)];
+
+		m_SensorContactsBuffer.clear();
+		OverlapAABB(sensorCollider.AABB, [this](ColliderID id, ColliderUserData userData)
+		{
+			m_SensorContactsBuffer.push_back({id, userData});
+			return true;
+		}, sensorCollider.Filter);
+		std::sort(m_SensorContactsBuffer.begin(), m_SensorContactsBuffer.end(),
+				  [](SensorContact const& contactA, SensorContact const& contactB) { return isOrderedBefore(contactA.ID, contactB.ID); });
+
+		auto addEvent = [&](SensorEventType type, SensorContact const& contact)
+		{
+			m_SensorEvents.push_back(SensorEvent
+			{
+				.Type = type,
+				.SensorID = sensor.ID,
+				.SensorUserData = sensorCollider.UserData,
+				.VisitorID = contact.ID,
+				.VisitorUserData = contact.UserData
+			});
+		};
+
+		// Both contact lists are sorted, walk them together to find the new, the kept and the lost contacts.
+		std::vector<SensorContact> const& previousContacts = sensor.Contacts;
+		std::size_t previousIndex = 0;
+		std::size_t currentIndex = 0;
+		while (previousIndex < previousContacts.size() || currentIndex < m_SensorContactsBuffer.size())
+		{
+			if (currentIndex == m_SensorContactsBuffer.size() ||
+				(previousIndex < previousContacts.size() && isOrderedBefore(previousContacts[previousIndex].ID, m_SensorContactsBuffer[currentIndex].ID)))
+			{
+				addEvent(SensorEventType::Exit, previousContacts[previousIndex]);
+				previousIndex++;
+			}
+			else if (previousIndex == previousContacts.size() || isOrderedBefore(m_SensorContactsBuffer[currentIndex].ID, previousContacts[previousIndex].ID))
+			{
+				addEvent(SensorEventType::Enter, m_SensorContactsBuffer[currentIndex]);
+				currentIndex++;
+			}
+			else
+			{
+				addEvent(SensorEventType::Stay, m_SensorContactsBuffer[currentIndex]);
+				previousIndex++;
+				currentIndex++;
+			}
+		}
+
+		std::swap(sensor.Contacts, m_SensorContactsBuffer);
+	}
+
+	std::int32_t ColliderManager::createBroadPhaseProxy(Math::AABB const& aabb, std::uint32_t slotIndex, std::uint32_t categoryBits)
+	{
+		switch (m_BroadPhaseSettings.Type)
+		{
+			case BroadPhaseType::DynamicAABBTree:
+				return m_AABBTree.CreateProxy(aabb, (std::int32_t) slotIndex, categoryBits);
+			case BroadPhaseType::SpatialHashGrid:
+				return m_SpatialHashGrid.CreateProxy(aabb, (std::int32_t) slotIndex, categoryBits);
+			case BroadPhaseType::Linear:
+				break;
+		}
+
+		return DynamicAABBTree::NullNode;
+	}
+
+	void ColliderManager::destroyBroadPhaseProxy(std::int32_t proxyId)
+	{
+		if (proxyId == DynamicAABBTree::NullNode)
+		{
+			// Sensors and the linear broad-phase have no proxy.
+			return;
+		}
+
+		switch (m_BroadPhaseSettings.Type)
+		{
+			case BroadPhaseType::DynamicAABBTree:
+				m_AABBTree.DestroyProxy(proxyId);
+				break;
+			case BroadPhaseType::SpatialHashGrid:
+				m_SpatialHashGrid.DestroyProxy(proxyId);
+				break;
+			case BroadPhaseType::Linear:
+				break;
+		}
+	}
+
+	void ColliderManager::moveBroadPhaseProxy(Collider const& collider)
+	{
+		std::int32_t const proxyId = collider.BroadPhaseProxyID;
+		if (proxyId == DynamicAABBTree::NullNode)
+		{
+			// Sensors and the linear broad-phase have no proxy.
+			return;
+		}
+
+		switch (m_BroadPhaseSettings.Type)
+		{
+			case BroadPhaseType::DynamicAABBTree:
+				m_AABBTree.MoveProxy(proxyId, collider.AABB, predictedDisplacementOf(collider));
+				break;
+			case BroadPhaseType::SpatialHashGrid:
+				m_SpatialHashGrid.MoveProxy(proxyId, collider.AABB);
+				break;
+			case BroadPhaseType::Linear:
+				break;
+		}
+	}
+
+	void ColliderManager::setBroadPhaseProxyCategoryBits(std::int32_t proxyId, std::uint32_t categoryBits)
+	{
+		if (proxyId == DynamicAABBTree::NullNode)
+		{
+			// Sensors and the linear broad-phase have no proxy.
+			return;
+		}
+
+		switch (m_BroadPhaseSettings.Type)
+		{
+			case BroadPhaseType::DynamicAABBTree:
+				m_AABBTree.SetCategoryBits(proxyId, categoryBits);
+				break;
+			case BroadPhaseType::SpatialHashGrid:
+				m_SpatialHashGrid.SetCategoryBits(proxyId, categoryBits);
+				break;
+			case BroadPhaseType::Linear:
+				break;
+		}
 	}
 }
\ No newline at end of file
@@ -1,54 +1,1207 @@
 #pragma once
 
+#include "src/BroadPhase.h"
+#include "src/CollisionKernels.h"
+#include "src/DynamicAABBTree.h"
+#include "src/InlineVector.h"
+#include "src/OrientedBox2D.h"
+#include "src/SpatialHashGrid.h"
+#include "src/StaticBVH.h"
+#include "src/SweepAndPrune.h"
+
 #include "Math/AABB.h"
 #include "Math/PrimitiveTest.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <span>
 #include <vector>
 
 namespace DYE
 {
-	using ColliderID = std::int32_t;
+	/// A generational handle to a collider registered in a ColliderManager.
+	/// The index points to a slot in the manager, the generation is bumped every time the slot is freed,
+	/// so a handle to an unregistered collider never resolves to a collider that reuses the same slot.
+	struct ColliderID
+	{
+		constexpr static std::uint32_t InvalidIndex = std::numeric_limits<std::uint32_t>::max();
+
+		std::uint32_t Index = InvalidIndex;
+		std::uint32_t Generation = 0;
+
+		bool IsValid() const { return Index != InvalidIndex; }
+		bool operator==(ColliderID const& other) const = default;
+	};
+
+	/// The collision layers of a collider, or of a query.
+	/// Two filters collide if the category bits of each one share a bit with the mask bits of the other one.
+	struct CollisionFilter
+	{
+		constexpr static std::uint32_t DefaultCategoryBits = 1u << 0;
+		constexpr static std::uint32_t AllBits = ~0u;
+
+		// The layers this collider (or query) belongs to.
+		std::uint32_t CategoryBits = DefaultCategoryBits;
+		// The layers this collider (or query) collides with.
+		std::uint32_t MaskBits = AllBits;
+
+		/// A query filter that sees every layer, the default of all the queries.
+		constexpr static CollisionFilter Everything() { return {AllBits, AllBits}; }
+
+		bool ShouldCollide(CollisionFilter const& other) const
+		{
+			return (CategoryBits & other.MaskBits) != 0 && (other.CategoryBits & MaskBits) != 0;
+		}
+	};
+
+	enum class ColliderMobility
+	{
+		Dynamic,	// Moved with SetAABB, kept in the incremental broad-phase.
+		Static		// Expected to never move, baked into a StaticBVH with the other static colliders.
+	};
+
+	/// A value attached to a collider by its owner, e.g. the index of (or a pointer to) the game object of the collider.
+	/// It is returned with the results, so the owner doesn't have to search its objects for the collider that has been hit.
+	using ColliderUserData = std::uintptr_t;
 
 	struct RaycastHit2D
 	{
 		ColliderID ColliderID;
+		ColliderUserData UserData;
 		float Time;
 		glm::vec2 Centroid;
 		glm::vec2 Point;
 		glm::vec2 Normal;
 	};
 
+	enum class SensorEventType
+	{
+		Enter,	// The visitor started overlapping with the sensor since the last update.
+		Stay,	// The visitor was already overlapping with the sensor at the last update.
+		Exit	// The visitor stopped overlapping with the sensor, or has been unregistered.
+	};
+
+	struct SensorEvent
+	{
+		SensorEventType Type;
+		ColliderID SensorID;
+		ColliderUserData SensorUserData;
+		ColliderID VisitorID;
+		ColliderUserData VisitorUserData;
+	};
+
+	enum class ContactEventType
+	{
+		Begin,	// The colliders started overlapping since the last update.
+		End		// The colliders stopped overlapping, or one of them has been unregistered.
+	};
+
+	struct ContactEvent
+	{
+		ContactEventType Type;
+		ColliderID ColliderA;
+		ColliderID ColliderB;
+	};
+
+	struct ColliderDistance2D
+	{
+		ColliderID ColliderID;
+		ColliderUserData UserData;
+		// 0 if the point is inside the collider.
+		float Distance;
+		// The point of the collider nearest to the query point.
+		glm::vec2 Point;
+	};
+
+	struct CircleCastResolveResult
+	{
+		glm::vec2 Center;
+		glm::vec2 Velocity;
+		std::uint32_t HitCount;
+		// The time left unresolved because the max number of casts has been reached, 0 if the whole time has been consumed.
+		float RemainingTime;
+	};
+
+	template<std::size_t Capacity, std::size_t MaxSensorCount>
+	class StaticColliderManager;
+
+	template<typename Callback>
+	concept OverlapCallback = std::predicate<Callback&, ColliderID> || std::predicate<Callback&, ColliderID, ColliderUserData>;
+
 	class ColliderManager
 	{
+		// Shares the collider representation and the narrow-phase.
+		template<std::size_t Capacity, std::size_t MaxSensorCount>
+		friend class StaticColliderManager;
+
 	private:
 		struct Collider
 		{
+			// The bounds of the collider, the collider itself unless it is oriented.
 			Math::AABB AABB;
+			// Always valid, an axis-aligned collider is stored as a box with no rotation.
+			OrientedBox2D OrientedBox;
+			// Units per second, only used to predict the broad-phase bounds.
 			glm::vec2 Velocity;
+			CollisionFilter Filter;
+			ColliderUserData UserData = 0;
+			bool IsSensor = false;
+			bool IsStatic = false;
+			bool IsOriented = false;
+			std::int32_t BroadPhaseProxyID = DynamicAABBTree::NullNode;
+			std::int32_t ContactPairProxyID = SweepAndPrune::NullProxy;
+		};
+
+		/// The colliders inflated by a fixed radius, in the same order as the dense colliders.
+		/// A circle of that radius touches a collider iff its center is inside the rounded inflated box,
+		/// so a circle cast becomes a ray cast against the inflated box, plus a corner test when the ray enters near a corner.
+		struct InflatedAABBCache
+		{
+			float Radius;
+			AABBStreams Bounds;
+		};
+
+		/// A collider the sensor overlapped with at the last update.
+		struct SensorContact
+		{
+			ColliderID ID;
+			ColliderUserData UserData;
+		};
+
+		struct Sensor
+		{
+			ColliderID ID;
+			// Sorted by collider id, so two updates can be compared with a single merge pass.
+			std::vector<SensorContact> Contacts;
+		};
+
+		/// Sparse entry of a collider handle.
+		struct Slot
+		{
+			std::uint32_t Generation = 1;
+			// Index into the dense collider array when the slot is in use, otherwise the next free slot.
+			std::uint32_t DenseIndexOrNextFree = ColliderID::InvalidIndex;
+			bool IsInUse = false;
 		};
 
 	public:
-		ColliderID RegisterAABB(Math::AABB aabb);
+		/// Queries recorded during an update and executed together, possibly across worker threads.
+		/// Defined in ColliderQueryBatch.h.
+		class QueryBatch;
+
+		/// A read-only copy of the colliders that other threads can read while the manager is modified.
+		/// Defined in ColliderSnapshot.h.
+		class Snapshot;
+
+		explicit ColliderManager(BroadPhaseSettings broadPhaseSettings = {});
+
+		/// Static colliders are kept out of the broad-phase selected in the settings, and baked together into a flat BVH
+		/// on the first query after the set of static colliders has changed, so they cost nothing per step.
+		/// Moving, refiltering or unregistering a static collider is allowed, but rebuilds the whole BVH.
+		/// The linear broad-phase treats every collider the same, it stays the reference.
+		ColliderID RegisterAABB(Math::AABB aabb, CollisionFilter filter = {}, ColliderUserData userData = 0,
+								ColliderMobility mobility = ColliderMobility::Dynamic);
 		void UnregisterAABB(ColliderID id);
 
+		/// Register a box rotated around its center. The broad-phase and the contact pairs work on the bounds of the box,
+		/// the queries test the box itself.
+		ColliderID RegisterOBB(OrientedBox2D const& box, CollisionFilter filter = {}, ColliderUserData userData = 0,
+							   ColliderMobility mobility = ColliderMobility::Dynamic);
+
 		bool IsColliderRegistered(ColliderID id) const;
+		/// The bounds of the collider, which is the collider itself unless it is oriented.
 		std::optional<Math::AABB> GetAABB(ColliderID id);
+		/// Setting an AABB makes the collider axis-aligned again.
 		bool SetAABB(ColliderID id, Math::AABB aabb);
 
-		std::vector<ColliderID> OverlapAABB(Math::AABB aabb) const;
-		std::vector<ColliderID> OverlapCircle(glm::vec2 center, float radius) const;
-		std::vector<RaycastHit2D> RaycastAll(glm::vec2 start, glm::vec2 end) const;
-		std::vector<RaycastHit2D> CircleCastAll(glm::vec2 center, float radius, glm::vec2 direction) const;
+		/// Start a batch of SetAABBs() calls, applied together by EndUpdate(): the updates are sorted by collider and written in one pass,
+		/// and the broad-phase is brought up to date once for the whole batch instead of once per collider.
+		/// Until EndUpdate(), the batched colliders keep their previous AABB for the queries, the contacts and the snapshots.
+		/// SetAABB() and the other setters stay immediate inside a batch.
+		void BeginUpdate();
+		/// Set aabbs[i] as the AABB of ids[i]. Outside of a batch it is applied right away, as a batch of its own.
+		/// If a collider is set several times in a batch the last AABB wins, the colliders no longer registered at EndUpdate() are skipped.
+		void SetAABBs(std::span<ColliderID const> ids, std::span<Math::AABB const> aabbs);
+		void EndUpdate();
+		std::optional<OrientedBox2D> GetOBB(ColliderID id) const;
+		bool SetOBB(ColliderID id, OrientedBox2D const& box);
+		std::optional<CollisionFilter> GetCollisionFilter(ColliderID id) const;
+		bool SetCollisionFilter(ColliderID id, CollisionFilter filter);
+		std::optional<ColliderUserData> GetUserData(ColliderID id) const;
+		bool SetUserData(ColliderID id, ColliderUserData userData);
+		/// The velocity of the collider, in units per second. It doesn't move the collider: the tree broad-phase stretches
+		/// the bounds of the collider along it (see BroadPhaseSettings::AABBTreePredictionTime), so the collider can keep moving
+		/// without being reinserted on every SetAABB. Queries still test where the collider is. The other broad-phases ignore it.
+		std::optional<glm::vec2> GetVelocity(ColliderID id) const;
+		bool SetVelocity(ColliderID id, glm::vec2 velocity);
+
+		/// The point of the collider nearest to the given point, the given point itself if it is inside the collider.
+		std::optional<glm::vec2> ClosestPoint(ColliderID id, glm::vec2 point) const;
+
+		/// Register a sensor: a collider that reports the colliders overlapping with it through UpdateSensors(),
+		/// but is never returned by the queries and never blocks a cast.
+		/// The filter of the sensor decides which colliders it detects, sensors don't detect each other.
+		ColliderID RegisterSensorAABB(Math::AABB aabb, CollisionFilter filter = {}, ColliderUserData userData = 0);
+		bool IsSensor(ColliderID id) const;
+
+		/// Find the colliders overlapping with every sensor, and replace the sensor events with the changes since the last update.
+		/// Call it once per step, after the colliders have been moved.
+		/// Unregistering a sensor drops its contacts without exit events.
+		void UpdateSensors();
+
+		/// The events of the last UpdateSensors() call, grouped by sensor and ordered by visitor id.
+		std::span<SensorEvent const> GetSensorEvents() const { return m_SensorEvents; }
+
+		/// Find every pair of overlapping colliders whose filters collide, and replace the contact events with the changes since the last update.
+		/// Only available if BroadPhaseSettings::TrackContactPairs is set, sensors are not paired.
+		/// Much cheaper than an OverlapAABB per collider: the pairs are swept along x and re-sorted incrementally.
+		void UpdateContactPairs();
+
+		std::span<ContactEvent const> GetContactEvents() const { return m_ContactEvents; }
+		std::size_t GetContactPairCount() const { return m_ContactPairs.GetPairCount(); }
 
+		/// Visit the overlapping pairs found by the last UpdateContactPairs() call.
+		/// \param callback void(ColliderID colliderA, ColliderID colliderB).
+		template<typename Callback>
+		void ForEachContactPair(Callback&& callback) const
+		{
+			m_ContactPairs.ForEachPair([&](std::uint64_t userDataA, std::uint64_t userDataB)
+			{
+				callback(colliderIDOfContactUserData(userDataA), colliderIDOfContactUserData(userDataB));
+			});
+		}
+
+		// Every query takes a filter, the candidates that shouldn't collide with it are rejected before the narrow-phase,
+		// and the AABB tree skips the subtrees that have none of the layers in the mask of the filter.
+
+		std::vector<ColliderID> OverlapAABB(Math::AABB aabb, CollisionFilter filter = CollisionFilter::Everything()) const;
+		std::vector<ColliderID> OverlapCircle(glm::vec2 center, float radius, CollisionFilter filter = CollisionFilter::Everything()) const;
+		std::vector<RaycastHit2D> RaycastAll(glm::vec2 start, glm::vec2 end, CollisionFilter filter = CollisionFilter::Everything()) const;
+		/// The hit time of a circle cast is the fraction of the direction at which the circle touches the collider,
+		/// with or without a registered radius.
+		std::vector<RaycastHit2D> CircleCastAll(glm::vec2 center, float radius, glm::vec2 direction, CollisionFilter filter = CollisionFilter::Everything()) const;
+
+		/// Find the nearest hit only. The segment is clipped by every hit found,
+		/// so farther candidates are rejected by the broad-phase without running the narrow-phase.
+		std::optional<RaycastHit2D> Raycast(glm::vec2 start, glm::vec2 end, CollisionFilter filter = CollisionFilter::Everything()) const;
+		std::optional<RaycastHit2D> CircleCast(glm::vec2 center, float radius, glm::vec2 direction, CollisionFilter filter = CollisionFilter::Everything()) const;
+
+		/// Move a circle with the given velocity for the given time, bouncing off every collider on the way:
+		/// at each hit the velocity is reflected about the hit normal and the circle is cast again for the time left,
+		/// until the whole time is consumed or maxCasts casts have been made. Nothing is allocated.
+		/// A collider the circle starts inside of, or is already moving away from (e.g. a paddle that has pushed into the ball),
+		/// doesn't block it: it is not a hit, and the circle is cast again without it until its next bounce.
+		/// Those recasts don't count towards maxCasts.
+		/// \param onHit void(RaycastHit2D const& hit, glm::vec2& velocity), called at each hit with the velocity already reflected,
+		/// it can change the velocity before the next cast, e.g. to add the velocity of the collider that has been hit.
+		template<typename HitCallback> requires std::invocable<HitCallback&, RaycastHit2D const&, glm::vec2&>
+		CircleCastResolveResult CircleCastResolve(glm::vec2 center, float radius, glm::vec2 velocity, float time, HitCallback&& onHit,
+												  CollisionFilter filter = CollisionFilter::Everything(), std::uint32_t maxCasts = DefaultMaxResolveCasts) const;
+
+		/// Sweep a kinematic box by the given delta and find the dynamic colliders it goes through, ordered by time of impact,
+		/// e.g. to push them out of the way. Static colliders are skipped, exclude the collider of the box itself with the filter.
+		/// The hit time is the fraction of the delta at which the box touches the collider, 0 with a zero normal if they already overlap.
+		/// The hit centroid is the center of the box at that time, and the hit normal is the normal of the collider face it touches.
+		std::vector<RaycastHit2D> SweepAABB(Math::AABB aabb, glm::vec2 delta, CollisionFilter filter = CollisionFilter::Everything()) const;
+
+		/// Cast an oriented box along the direction and find every collider it touches, ordered by time of impact.
+		/// Unlike SweepAABB, static colliders are hit as well. The hit time is the fraction of the direction at which the box touches the collider,
+		/// 0 with a zero normal if they already overlap. The hit centroid is the center of the box at that time.
+		/// The linear broad-phase runs the separating axis test on several candidates per instruction,
+		/// the other broad-phases cast the bounds of the box and confirm the candidates one by one.
+		std::vector<RaycastHit2D> BoxCastAll(OrientedBox2D const& box, glm::vec2 direction, CollisionFilter filter = CollisionFilter::Everything()) const;
+		std::optional<RaycastHit2D> BoxCast(OrientedBox2D const& box, glm::vec2 direction, CollisionFilter filter = CollisionFilter::Everything()) const;
+
+		/// Cast a fan of rays from the same start point, outHits[i] is set to the nearest hit of the ray towards ends[i].
+		/// The rays are grouped in packets of RayPacket::MaxRayCount, each packet is tested against a candidate box at once
+		/// and shares one broad-phase traversal. outHits must be as large as ends.
+		void RaycastPacket(glm::vec2 start, std::span<glm::vec2 const> ends, std::span<std::optional<RaycastHit2D>> outHits, CollisionFilter filter = CollisionFilter::Everything()) const;
+
+		// Allocation-free variants of the queries above.
+
+		/// Visit the overlapped colliders as they are found.
+		/// \param callback bool(ColliderID id) or bool(ColliderID id, ColliderUserData userData), return false to stop the query early.
+		template<typename Callback> requires OverlapCallback<Callback>
+		void OverlapAABB(Math::AABB aabb, Callback&& callback, CollisionFilter filter = CollisionFilter::Everything()) const;
+		template<typename Callback> requires OverlapCallback<Callback>
+		void OverlapCircle(glm::vec2 center, float radius, Callback&& callback, CollisionFilter filter = CollisionFilter::Everything()) const;
+
+		/// Visit the hits as they are found, the hits are NOT ordered by time.
+		/// \param callback bool(RaycastHit2D const& hit), return false to stop the cast early.
+		template<typename Callback> requires std::predicate<Callback&, RaycastHit2D const&>
+		void RaycastAll(glm::vec2 start, glm::vec2 end, Callback&& callback, CollisionFilter filter = CollisionFilter::Everything()) const;
+		template<typename Callback> requires std::predicate<Callback&, RaycastHit2D const&>
+		void CircleCastAll(glm::vec2 center, float radius, glm::vec2 direction, Callback&& callback, CollisionFilter filter = CollisionFilter::Everything()) const;
+		template<typename Callback> requires std::predicate<Callback&, RaycastHit2D const&>
+		void SweepAABB(Math::AABB aabb, glm::vec2 delta, Callback&& callback, CollisionFilter filter = CollisionFilter::Everything()) const;
+		template<typename Callback> requires std::predicate<Callback&, RaycastHit2D const&>
+		void BoxCastAll(OrientedBox2D const& box, glm::vec2 direction, Callback&& callback, CollisionFilter filter = CollisionFilter::Everything()) const;
+
+		/// Clear the given buffer and fill it with the results. The capacity of the buffer is reused between calls.
+		void OverlapAABB(Math::AABB aabb, std::vector<ColliderID>& results, CollisionFilter filter = CollisionFilter::Everything()) const;
+		void OverlapCircle(glm::vec2 center, float radius, std::vector<ColliderID>& results, CollisionFilter filter = CollisionFilter::Everything()) const;
+		void RaycastAll(glm::vec2 start, glm::vec2 end, std::vector<RaycastHit2D>& results, CollisionFilter filter = CollisionFilter::Everything()) const;
+		void CircleCastAll(glm::vec2 center, float radius, glm::vec2 direction, std::vector<RaycastHit2D>& results, CollisionFilter filter = CollisionFilter::Everything()) const;
+		void SweepAABB(Math::AABB aabb, glm::vec2 delta, std::vector<RaycastHit2D>& results, CollisionFilter filter = CollisionFilter::Everything()) const;
+		void BoxCastAll(OrientedBox2D const& box, glm::vec2 direction, std::vector<RaycastHit2D>& results, CollisionFilter filter = CollisionFilter::Everything()) const;
+
+		/// Write at most results.size() results into the given span.
+		/// For casts, the nearest hits are kept and ordered by time.
+		/// \return the number of results written.
+		std::size_t OverlapAABB(Math::AABB aabb, std::span<ColliderID> results, CollisionFilter filter = CollisionFilter::Everything()) const;
+		std::size_t OverlapCircle(glm::vec2 center, float radius, std::span<ColliderID> results, CollisionFilter filter = CollisionFilter::Everything()) const;
+		std::size_t RaycastAll(glm::vec2 start, glm::vec2 end, std::span<RaycastHit2D> results, CollisionFilter filter = CollisionFilter::Everything()) const;
+		std::size_t CircleCastAll(glm::vec2 center, float radius, glm::vec2 direction, std::span<RaycastHit2D> results, CollisionFilter filter = CollisionFilter::Everything()) const;
+		std::size_t SweepAABB(Math::AABB aabb, glm::vec2 delta, std::span<RaycastHit2D> results, CollisionFilter filter = CollisionFilter::Everything()) const;
+		std::size_t BoxCastAll(OrientedBox2D const& box, glm::vec2 direction, std::span<RaycastHit2D> results, CollisionFilter filter = CollisionFilter::Everything()) const;
+
+		/// Find the collider nearest to the point, colliders farther than the max distance are ignored.
+		/// The tree and the static BVH are searched with branch and bound, nearest nodes first, so the search stops opening nodes
+		/// as soon as the nearest collider so far is nearer than them. The grid has no hierarchy to bound, it scans the bounds like the linear broad-phase.
+		std::optional<ColliderDistance2D> NearestCollider(glm::vec2 point, float maxDistance = std::numeric_limits<float>::infinity(),
+														  CollisionFilter filter = CollisionFilter::Everything()) const;
+
+		/// Find the k colliders nearest to the point, ordered by distance. Same search as NearestCollider, bounded by the k-th nearest collider so far.
+		std::vector<ColliderDistance2D> KNearest(glm::vec2 point, std::size_t k, float maxDistance = std::numeric_limits<float>::infinity(),
+												 CollisionFilter filter = CollisionFilter::Everything()) const;
+
+		/// Allocation-free KNearest, with k = results.size().
+		/// \return the number of results written.
+		std::size_t KNearest(glm::vec2 point, std::span<ColliderDistance2D> results, float maxDistance = std::numeric_limits<float>::infinity(),
+							 CollisionFilter filter = CollisionFilter::Everything()) const;
+
+		/// Keep the colliders inflated by the given radius cached, so casts of circles with exactly that radius
+		/// skip rebuilding the expansion for every candidate. Use it for the radii of hot casts, e.g. a ball of a fixed size.
+		/// Every cached radius adds a little work to RegisterAABB and SetAABB.
+		void RegisterCircleCastRadius(float radius);
+		void UnregisterCircleCastRadius(float radius);
+
+		/// Build the BVH of the static colliders now instead of on the next query, e.g. right after loading a level.
+		void BakeStaticColliders() const { bakeStaticCollidersIfDirty(); }
+
+		BroadPhaseType GetBroadPhaseType() const { return m_BroadPhaseSettings.Type; }
+		std::size_t GetColliderCount() const { return m_Colliders.size(); }
+
+		/// Make the current state of the colliders the snapshot returned by GetSnapshot(), and return it.
+		/// Two snapshots are published in turn: each one is brought up to date by copying the colliders changed since it was last published,
+		/// so publishing costs O(changed colliders) as long as the readers have released the snapshot published before the current one.
+		/// Call it from the thread modifying the manager, e.g. once per step. Changes are only tracked once a first snapshot has been published.
+		std::shared_ptr<Snapshot const> PublishSnapshot();
+
+		/// The last published snapshot, null if none has been published. Safe to call from any thread.
+		std::shared_ptr<Snapshot const> GetSnapshot() const;
+
+		/// Both read the live colliders and DrawImGui modifies them: call them from the thread modifying the manager,
+		/// other threads draw a published Snapshot instead.
 		void DrawGizmos() const;
+		/// Only draw the colliders overlapping the view bounds, e.g. WindowCamera::GetViewBounds(). They are found through the broad-phase,
+		/// so the cost follows the colliders on screen rather than all the registered ones.
+		void DrawGizmos(Math::AABB const& viewBounds) const;
 		void DrawImGui();
 
+		/// Counters of the queries run on the calling thread since the last reset, for the benchmarks.
+		/// Only counted in builds defining DYE_COLLIDER_QUERY_STATS, they stay 0 otherwise and cost nothing.
+		struct QueryStats
+		{
+			// The broad-phase candidates handed to the filter test and then to the narrow-phase.
+			std::uint64_t CandidateCount;
+		};
+
+		static QueryStats GetThreadQueryStats() { return s_ThreadQueryStats; }
+		static void ResetThreadQueryStats() { s_ThreadQueryStats = {}; }
+
 	private:
-		int binarySearchIndexOf(std::vector<std::pair<ColliderID, Math::AABB>> const& collection, ColliderID id) const;
+		/// \return the index of the collider in the dense array, or InvalidIndex if the handle is stale.
+		std::uint32_t denseIndexOf(ColliderID id) const
+		{
+			if (id.Index >= m_Slots.size())
+			{
+				return ColliderID::InvalidIndex;
+			}
+
+			Slot const& slot = m_Slots[id.Index];
+			if (!slot.IsInUse || slot.Generation != id.Generation)
+			{
+				return ColliderID::InvalidIndex;
+			}
+
+			return slot.DenseIndexOrNextFree;
+		}
+
+		ColliderID idOfSlot(std::uint32_t slotIndex) const { return {slotIndex, m_Slots[slotIndex].Generation}; }
+
+		ColliderID registerCollider(Math::AABB const& aabb, CollisionFilter const& filter, ColliderUserData userData, bool isSensor, bool isStatic);
+
+		/// Set the AABB of the collider everywhere but in the broad-phase, which SetAABB() moves right away and EndUpdate() once per batch.
+		void setColliderAABB(std::uint32_t denseIndex, Math::AABB const& aabb);
+
+		/// Record that the collider in the slot has changed, so both snapshots copy it the next time they are published.
+		void markSnapshotDirty(std::uint32_t slotIndex);
+		void copySlotToSnapshot(Snapshot& snapshot, std::uint32_t slotIndex) const;
+
+		bool isInStaticBVH(Collider const& collider) const { return collider.IsStatic && m_BroadPhaseSettings.Type != BroadPhaseType::Linear; }
+
+		/// Rebuild the static BVH if a static collider has changed since the last build.
+		/// Queries are const and might run on several threads at once, so the build is guarded by a lock.
+		void bakeStaticCollidersIfDirty() const;
+
+		/// Sensors are only ever looked up by UpdateSensors(), the queries skip them.
+		/// Every broad-phase candidate goes through here before the narrow-phase, so this is where the candidates are counted.
+		static bool isVisibleToQuery(Collider const& collider, CollisionFilter const& filter)
+		{
+#if defined(DYE_COLLIDER_QUERY_STATS)
+			s_ThreadQueryStats.CandidateCount++;
+#endif
+			return !collider.IsSensor && filter.ShouldCollide(collider.Filter);
+		}
+
+		static bool isOrderedBefore(ColliderID idA, ColliderID idB)
+		{
+			return idA.Index != idB.Index? idA.Index < idB.Index : idA.Generation < idB.Generation;
+		}
+
+		void updateSensor(Sensor& sensor);
+
+		// The sweep and prune user data of a collider is its handle, so the pairs of an unregistered collider can still be reported.
+		static std::uint64_t contactUserDataOf(ColliderID id) { return ((std::uint64_t) id.Index << 32) | id.Generation; }
+		static ColliderID colliderIDOfContactUserData(std::uint64_t userData)
+		{
+			return {(std::uint32_t) (userData >> 32), (std::uint32_t) (userData & 0xFFFFFFFFu)};
+		}
+
+		std::int32_t createBroadPhaseProxy(Math::AABB const& aabb, std::uint32_t slotIndex, std::uint32_t categoryBits);
+		void destroyBroadPhaseProxy(std::int32_t proxyId);
+		void moveBroadPhaseProxy(Collider const& collider);
+		glm::vec2 predictedDisplacementOf(Collider const& collider) const { return collider.Velocity * m_BroadPhaseSettings.AABBTreePredictionTime; }
+		void setBroadPhaseProxyCategoryBits(std::int32_t proxyId, std::uint32_t categoryBits);
+
+		/// Visit the colliders that might overlap with the given box, and should collide with the filter.
+		/// \param callback bool(ColliderID id, Collider const& collider), return false to stop the query.
+		template<typename Callback>
+		void queryBroadPhase(glm::vec2 min, glm::vec2 max, CollisionFilter const& filter, Callback&& callback) const;
+
+		/// Same as queryBroadPhase with the bounds of the circle, but the linear broad-phase can reject the corners of the bounds.
+		template<typename Callback>
+		void queryCircleBroadPhase(glm::vec2 center, float radius, CollisionFilter const& filter, Callback&& callback) const;
+
+		/// Visit the colliders that might be touched by a box of the given half extents swept along the segment, and should collide with the filter.
+		/// \param callback float(ColliderID id, Collider const& collider, float maxFraction),
+		/// return the new max fraction of the segment, or 0 to stop the cast.
+		/// \param isDynamicOnly skip the static colliders, the static BVH isn't cast at all.
+		template<typename Callback>
+		void castBroadPhase(glm::vec2 start, glm::vec2 displacement, glm::vec2 halfExtents, CollisionFilter const& filter, Callback&& callback,
+							bool isDynamicOnly = false) const;
+
+		/// Visit the colliders that might be touched by the oriented box moved along the displacement, and should collide with the filter.
+		/// \param callback float(ColliderID id, Collider const& collider, float maxFraction),
+		/// return the new max fraction of the displacement, or 0 to stop the cast.
+		template<typename Callback>
+		void castOrientedBoxBroadPhase(OrientedBox2D const& box, glm::vec2 displacement, CollisionFilter const& filter, Callback&& callback) const;
+
+		/// Visit the colliders that might be nearer to the point than the bound, and should collide with the filter.
+		/// \param callback float(ColliderID id, Collider const& collider, float maxDistanceSquared), return the new bound.
+		template<typename Callback>
+		void nearestBroadPhase(glm::vec2 point, float maxDistanceSquared, CollisionFilter const& filter, Callback&& callback) const;
+
+		static bool overlapCollider(Collider const& collider, Math::AABB const& aabb)
+		{
+			if (collider.IsOriented)
+			{
+				return OrientedBoxesIntersect(collider.OrientedBox, OrientedBox2D::CreateFromAABB(aabb));
+			}
+			return Math::AABBAABBIntersect2D(collider.AABB, aabb);
+		}
+
+		static bool overlapCollider(Collider const& collider, glm::vec2 center, float radius)
+		{
+			if (collider.IsOriented)
+			{
+				// The circle doesn't change with the rotation, test it in the space of the box.
+				OrientedBox2D const& box = collider.OrientedBox;
+				return Math::AABBCircleIntersect(box.GetLocalAABB(), box.ToLocalPoint(center), radius);
+			}
+			return Math::AABBCircleIntersect(collider.AABB, center, radius);
+		}
+
+		static glm::vec2 closestPointOf(Collider const& collider, glm::vec2 point)
+		{
+			if (collider.IsOriented)
+			{
+				return collider.OrientedBox.ClosestPoint(point);
+			}
+			return glm::clamp(point, glm::vec2 {collider.AABB.Min}, glm::vec2 {collider.AABB.Max});
+		}
+
+		static bool raycastCollider(ColliderID id, Collider const& collider, glm::vec2 start, glm::vec2 direction, float maxDistance, RaycastHit2D& outHit)
+		{
+			Math::DynamicTestResult2D testResult;
+			bool intersect;
+			if (collider.IsOriented)
+			{
+				OrientedBox2D const& box = collider.OrientedBox;
+				intersect = Math::RayAABBIntersect2D(box.ToLocalPoint(start), box.ToLocalDirection(direction), maxDistance, box.GetLocalAABB(), testResult);
+				if (intersect)
+				{
+					box.ToWorldResult(testResult);
+				}
+			}
+			else
+			{
+				intersect = Math::RayAABBIntersect2D(start, direction, maxDistance, collider.AABB, testResult);
+			}
+
+			if (intersect)
+			{
+				outHit = RaycastHit2D { .ColliderID = id, .UserData = collider.UserData, .Time = testResult.HitTime, .Centroid = testResult.HitCentroid, .Point = testResult.HitPoint, .Normal = testResult.HitNormal };
+			}
+			return intersect;
+		}
+
+		static bool circleCastCollider(ColliderID id, Collider const& collider, glm::vec2 center, float radius, glm::vec2 direction, RaycastHit2D& outHit)
+		{
+			Math::DynamicTestResult2D testResult;
+			bool intersect;
+			if (collider.IsOriented)
+			{
+				OrientedBox2D const& box = collider.OrientedBox;
+				intersect = Math::MovingCircleAABBIntersect(box.ToLocalPoint(center), radius, box.ToLocalDirection(direction), box.GetLocalAABB(), testResult);
+				if (intersect)
+				{
+					box.ToWorldResult(testResult);
+				}
+			}
+			else
+			{
+				intersect = Math::MovingCircleAABBIntersect(center, radius, direction, collider.AABB, testResult);
+			}
+
+			if (intersect)
+			{
+				// The time is measured from the centroid, so it is a fraction of the direction like the one of the cached test.
+				float const time = fractionAlongCast(testResult.HitCentroid, center, direction);
+				outHit = RaycastHit2D { .ColliderID = id, .UserData = collider.UserData, .Time = time, .Centroid = testResult.HitCentroid, .Point = testResult.HitPoint, .Normal = testResult.HitNormal };
+			}
+			return intersect;
+		}
+
+		/// The fraction of the displacement at which the cast reaches the projection of the point, 0 if the displacement is zero.
+		static float fractionAlongCast(glm::vec2 point, glm::vec2 start, glm::vec2 displacement)
+		{
+			float const displacementLengthSquared = glm::dot(displacement, displacement);
+			if (displacementLengthSquared <= 0.0f)
+			{
+				return 0.0f;
+			}
+
+			return glm::clamp(glm::dot(point - start, displacement) / displacementLengthSquared, 0.0f, 1.0f);
+		}
+
+		static Math::AABB inflateAABB(Math::AABB const& aabb, float radius)
+		{
+			Math::AABB inflated = aabb;
+			inflated.Min -= glm::vec3 {radius, radius, 0};
+			inflated.Max += glm::vec3 {radius, radius, 0};
+			return inflated;
+		}
+
+		InflatedAABBCache const* tryGetInflatedAABBCache(float radius) const
+		{
+			for (InflatedAABBCache const& cache : m_InflatedAABBCaches)
+			{
+				if (cache.Radius == radius)
+				{
+					return &cache;
+				}
+			}
+
+			return nullptr;
+		}
+
+		/// Narrow-phase of a circle cast, against the cached inflated box if the radius has a cache.
+		/// The cache holds the inflated bounds, so oriented colliders always take the exact test.
+		bool circleCastCollider(ColliderID id, Collider const& collider, float radius, BroadPhaseSegment const& segment,
+								InflatedAABBCache const* pInflatedAABBCache, RaycastHit2D& outHit) const
+		{
+			if (pInflatedAABBCache == nullptr || collider.IsOriented)
+			{
+				return circleCastCollider(id, collider, segment.Start, radius, segment.Displacement, outHit);
+			}
+
+			std::uint32_t const denseIndex = denseIndexOf(id);
+			AABBStreams const& bounds = pInflatedAABBCache->Bounds;
+			glm::vec2 const inflatedMin {bounds.MinX[denseIndex], bounds.MinY[denseIndex]};
+			glm::vec2 const inflatedMax {bounds.MaxX[denseIndex], bounds.MaxY[denseIndex]};
+			return circleCastInflatedCollider(id, collider, inflatedMin, inflatedMax, radius, segment, outHit);
+		}
+
+		/// The hit of Math::MovingCircleAABBIntersect, with the inflated box given. The hit time is the fraction of the displacement.
+		static bool circleCastInflatedCollider(ColliderID id, Collider const& collider, glm::vec2 inflatedMin, glm::vec2 inflatedMax,
+											   float radius, BroadPhaseSegment const& segment, RaycastHit2D& outHit);
+
+		/// Narrow-phase of a box sweep, a slab test of the box center against the collider inflated by the half extents of the box.
+		/// Oriented colliders take the separating axis test instead.
+		static bool sweepAABBCollider(ColliderID id, Collider const& collider, glm::vec2 halfExtents, BroadPhaseSegment const& segment, RaycastHit2D& outHit);
+
+		/// Narrow-phase of a box cast, MovingOrientedBoxIntersect against the collider.
+		static bool boxCastCollider(ColliderID id, Collider const& collider, OrientedBox2D const& box, glm::vec2 displacement, RaycastHit2D& outHit)
+		{
+			Math::DynamicTestResult2D testResult;
+			bool const intersect = MovingOrientedBoxIntersect(box, displacement, collider.OrientedBox, testResult);
+			if (intersect)
+			{
+				outHit = RaycastHit2D { .ColliderID = id, .UserData = collider.UserData, .Time = testResult.HitTime, .Centroid = testResult.HitCentroid, .Point = testResult.HitPoint, .Normal = testResult.HitNormal };
+			}
+			return intersect;
+		}
+
+		/// The fraction of the cast displacement at which the hit happens, used to clip the broad-phase segment.
+		/// A small tolerance is added so candidates tied with the hit are still tested.
+		static float clipFractionOf(RaycastHit2D const& hit, glm::vec2 start, glm::vec2 displacement)
+		{
+			float const displacementLengthSquared = glm::dot(displacement, displacement);
+			if (displacementLengthSquared <= 0.0f)
+			{
+				return 1.0f;
+			}
+
+			float const fraction = glm::dot(hit.Centroid - start, displacement) / displacementLengthSquared;
+			return glm::max(fraction, 0.0f) * (1.0f + ClipFractionTolerance) + ClipFractionTolerance;
+		}
+
+		constexpr static float ClipFractionTolerance = 0.0001f;
+
+		/// CircleCast skipping the given colliders.
+		std::optional<RaycastHit2D> nearestCircleCast(glm::vec2 center, float radius, glm::vec2 direction, CollisionFilter const& filter,
+													  std::span<ColliderID const> ignoredIDs) const;
+
+		/// The bounces of CircleCastResolve.
+		/// \param castCircle std::optional<RaycastHit2D>(glm::vec2 center, glm::vec2 displacement, std::span<ColliderID const> ignoredIDs),
+		/// the nearest hit of the circle moved by the displacement, ignoring the given colliders.
+		template<typename CastFunction, typename HitCallback>
+		static CircleCastResolveResult resolveCircleCasts(glm::vec2 center, glm::vec2 velocity, float time, CastFunction&& castCircle, HitCallback& onHit, std::uint32_t maxCasts);
+
+		constexpr static std::uint32_t DefaultMaxResolveCasts = 4;
+
+		// How many colliders the circle can be cast through between two bounces, e.g. a ball squeezed between a paddle and a wall.
+		// Past that the circle is considered stuck and stops for the step.
+		constexpr static std::size_t MaxResolveIgnoredColliders = 8;
+
+		// How far a resolved circle is pushed away from a hit collider along the hit normal, so the next cast doesn't start touching it.
+		constexpr static float ResolveContactOffset = 0.0001f;
+
+		template<typename Callback>
+		static bool invokeOverlapCallback(Callback& callback, ColliderID id, Collider const& collider)
+		{
+			if constexpr (std::predicate<Callback&, ColliderID, ColliderUserData>)
+			{
+				return callback(id, collider.UserData);
+			}
+			else
+			{
+				return callback(id);
+			}
+		}
+
+		/// Cast at most RayPacket::MaxRayCount rays as one packet.
+		void raycastPacket(glm::vec2 start, std::span<glm::vec2 const> ends, std::span<std::optional<RaycastHit2D>> outHits, CollisionFilter const& filter) const;
+
+		/// Add the hit to the span if there is room, otherwise replace the farthest hit if the new one is nearer.
+		static void keepNearestHit(std::span<RaycastHit2D> results, std::size_t& count, RaycastHit2D const& hit);
+
+		static void drawColliderGizmo(Collider const& collider);
+		/// One row of the DrawImGui() inspector, the collider in the slot must be registered.
+		void drawColliderInspectorRow(std::uint32_t slotIndex);
+		static bool isInView(Collider const& collider, glm::vec2 viewMin, glm::vec2 viewMax)
+		{
+			return collider.AABB.Min.x <= viewMax.x && viewMin.x <= collider.AABB.Max.x &&
+				   collider.AABB.Min.y <= viewMax.y && viewMin.y <= collider.AABB.Max.y;
+		}
 
 	private:
-		ColliderID m_AABBIdCounter = 0;
-		std::vector<std::pair<ColliderID, Math::AABB>> m_AABBs;
+		BroadPhaseSettings m_BroadPhaseSettings;
+		DynamicAABBTree m_AABBTree;
+		SpatialHashGrid m_SpatialHashGrid;
+
+		// Sparse set: handles index into the slots, slots index into the dense arrays.
+		// The dense arrays are kept tightly packed (swap and pop on removal) so linear passes stay cache friendly.
+		std::vector<Slot> m_Slots;
+		std::uint32_t m_FreeSlotHead = ColliderID::InvalidIndex;
+		std::uint32_t m_FreeSlotTail = ColliderID::InvalidIndex;
+
+		std::vector<Collider> m_Colliders;
+		std::vector<std::uint32_t> m_DenseToSlot;
+
+		// A structure of arrays mirror of the dense collider bounds, scanned by the SIMD kernels in the linear broad-phase.
+		AABBStreams m_ColliderBounds;
+		// The same colliders as oriented boxes, scanned by the box cast kernel in the linear broad-phase.
+		OrientedBoxStreams m_ColliderBoxes;
+
+		std::vector<InflatedAABBCache> m_InflatedAABBCaches;
+
+		struct PendingAABBUpdate
+		{
+			ColliderID ID;
+			Math::AABB AABB;
+			// Resolved by EndUpdate(), an unregister during the batch moves the dense indices.
+			std::uint32_t DenseIndex;
+		};
+
+		// The SetAABBs() calls since BeginUpdate(), kept with their buffers between batches so they don't allocate.
+		bool m_IsUpdating = false;
+		std::vector<PendingAABBUpdate> m_PendingAABBUpdates;
+		std::vector<std::int32_t> m_MovedProxyIDs;
+		std::vector<Math::AABB> m_MovedProxyAABBs;
+		std::vector<glm::vec2> m_MovedProxyDisplacements;
+
+		// The static colliders, rebuilt lazily by the first query that finds the dirty flag set.
+		mutable StaticBVH m_StaticBVH;
+		mutable std::mutex m_StaticBVHMutex;
+		mutable std::atomic<bool> m_IsStaticBVHDirty = false;
+
+		SweepAndPrune m_ContactPairs;
+		std::vector<ContactEvent> m_ContactEvents;
+
+		std::vector<Sensor> m_Sensors;
+		std::vector<SensorEvent> m_SensorEvents;
+		// The contacts found for the sensor being updated, swapped with the contacts of the sensor afterwards.
+		std::vector<SensorContact> m_SensorContactsBuffer;
+
+		// The two snapshots published in turn, the n-th publish reuses m_Snapshots[n % 2].
+		// m_SnapshotDirtySlots[i] lists the slots changed since m_Snapshots[i] was last published,
+		// bit i of m_SnapshotDirtyBits[slot] is set if the slot is in that list.
+		std::array<std::shared_ptr<Snapshot>, 2> m_Snapshots;
+		std::array<std::vector<std::uint32_t>, 2> m_SnapshotDirtySlots;
+		std::vector<std::uint8_t> m_SnapshotDirtyBits;
+		std::uint64_t m_SnapshotEpoch = 0;
+
+		// Read by GetSnapshot() from any thread.
+		std::shared_ptr<Snapshot const> m_PublishedSnapshot;
+		mutable std::mutex m_PublishedSnapshotMutex;
+
+		// The state of the DrawImGui() inspector.
+		int m_InspectorSlotFilter = -1;
+		int m_InspectorPage = 0;
+
+		// Per thread, so queries running on several workers don't contend on the counters. Zero-initialized like any static.
+		inline static thread_local QueryStats s_ThreadQueryStats;
 	};
+
+	template<typename Callback>
+	void ColliderManager::queryBroadPhase(glm::vec2 min, glm::vec2 max, CollisionFilter const& filter, Callback&& callback) const
+	{
+		bool isStopped = false;
+		auto visitProxy = [&](std::int32_t slotIndex)
+		{
+			Collider const& collider = m_Colliders[m_Slots[slotIndex].DenseIndexOrNextFree];
+			if (!isVisibleToQuery(collider, filter))
+			{
+				return true;
+			}
+			isStopped = !callback(idOfSlot(slotIndex), collider);
+			return !isStopped;
+		};
+
+		switch (m_BroadPhaseSettings.Type)
+		{
+			case BroadPhaseType::DynamicAABBTree:
+				m_AABBTree.Query(min, max, visitProxy, filter.MaskBits);
+				break;
+			case BroadPhaseType::SpatialHashGrid:
+				m_SpatialHashGrid.Query(min, max, visitProxy, filter.MaskBits);
+				break;
+			case BroadPhaseType::Linear:
+			{
+				std::array<std::uint32_t, CollisionKernels::ChunkSize> candidates;
+				for (std::uint32_t begin = 0; begin < m_ColliderBounds.Size(); begin += CollisionKernels::ChunkSize)
+				{
+					std::uint32_t const end = glm::min(begin + CollisionKernels::ChunkSize, m_ColliderBounds.Size());
+					std::uint32_t const candidateCount = CollisionKernels::OverlapBox(m_ColliderBounds, begin, end, min, max, candidates.data());
+					for (std::uint32_t i = 0; i < candidateCount; i++)
+					{
+						std::uint32_t const denseIndex = candidates[i];
+						if (!isVisibleToQuery(m_Colliders[denseIndex], filter))
+						{
+							continue;
+						}
+
+						bool const shouldContinue = callback(idOfSlot(m_DenseToSlot[denseIndex]), m_Colliders[denseIndex]);
+						if (!shouldContinue)
+						{
+							return;
+						}
+					}
+				}
+				return;
+			}
+		}
+
+		if (!isStopped)
+		{
+			bakeStaticCollidersIfDirty();
+			m_StaticBVH.Query(min, max, visitProxy, filter.MaskBits);
+		}
+	}
+
+	template<typename Callback>
+	void ColliderManager::queryCircleBroadPhase(glm::vec2 center, float radius, CollisionFilter const& filter, Callback&& callback) const
+	{
+		if (m_BroadPhaseSettings.Type != BroadPhaseType::Linear)
+		{
+			glm::vec2 const extents {radius, radius};
+			queryBroadPhase(center - extents, center + extents, filter, callback);
+			return;
+		}
+
+		std::array<std::uint32_t, CollisionKernels::ChunkSize> candidates;
+		for (std::uint32_t begin = 0; begin < m_ColliderBounds.Size(); begin += CollisionKernels::ChunkSize)
+		{
+			std::uint32_t const end = glm::min(begin + CollisionKernels::ChunkSize, m_ColliderBounds.Size());
+			std::uint32_t const candidateCount = CollisionKernels::OverlapCircle(m_ColliderBounds, begin, end, center, radius, candidates.data());
+			for (std::uint32_t i = 0; i < candidateCount; i++)
+			{
+				std::uint32_t const denseIndex = candidates[i];
+				if (!isVisibleToQuery(m_Colliders[denseIndex], filter))
+				{
+					continue;
+				}
+
+				bool const shouldContinue = callback(idOfSlot(m_DenseToSlot[denseIndex]), m_Colliders[denseIndex]);
+				if (!shouldContinue)
+				{
+					return;
+				}
+			}
+		}
+	}
+
+	template<typename Callback>
+	void ColliderManager::castBroadPhase(glm::vec2 start, glm::vec2 displacement, glm::vec2 halfExtents, CollisionFilter const& filter, Callback&& callback,
+										 bool isDynamicOnly) const
+	{
+		// The static BVH is cast after the broad-phase, starting with the segment as clipped by the broad-phase hits.
+		float castMaxFraction = 1.0f;
+		auto visitProxy = [&](std::int32_t slotIndex, float maxFraction)
+		{
+			Collider const& collider = m_Colliders[m_Slots[slotIndex].DenseIndexOrNextFree];
+			if (!isVisibleToQuery(collider, filter))
+			{
+				return maxFraction;
+			}
+			float const newMaxFraction = callback(idOfSlot(slotIndex), collider, maxFraction);
+			castMaxFraction = glm::min(castMaxFraction, newMaxFraction);
+			return newMaxFraction;
+		};
+
+		switch (m_BroadPhaseSettings.Type)
+		{
+			case BroadPhaseType::DynamicAABBTree:
+				m_AABBTree.RayCast(start, displacement, halfExtents, visitProxy, filter.MaskBits);
+				break;
+			case BroadPhaseType::SpatialHashGrid:
+				m_SpatialHashGrid.RayCast(start, displacement, halfExtents, visitProxy, filter.MaskBits);
+				break;
+			case BroadPhaseType::Linear:
+			{
+				BroadPhaseSegment const segment = BroadPhaseSegment::Create(start, displacement);
+				std::array<std::uint32_t, CollisionKernels::ChunkSize> candidates;
+
+				float maxFraction = 1.0f;
+				for (std::uint32_t begin = 0; begin < m_ColliderBounds.Size(); begin += CollisionKernels::ChunkSize)
+				{
+					std::uint32_t const end = glm::min(begin + CollisionKernels::ChunkSize, m_ColliderBounds.Size());
+					float const chunkMaxFraction = maxFraction;
+					std::uint32_t const candidateCount = CollisionKernels::SweptBox(m_ColliderBounds, begin, end, segment, halfExtents, chunkMaxFraction, candidates.data());
+					for (std::uint32_t i = 0; i < candidateCount; i++)
+					{
+						std::uint32_t const denseIndex = candidates[i];
+						if ((isDynamicOnly && m_Colliders[denseIndex].IsStatic) || !isVisibleToQuery(m_Colliders[denseIndex], filter))
+						{
+							continue;
+						}
+
+						Math::AABB const& aabb = m_Colliders[denseIndex].AABB;
+
+						// The segment might have been clipped by a hit earlier in this chunk.
+						float entryFraction;
+						if (maxFraction < chunkMaxFraction &&
+							!segment.IntersectBox(glm::vec2 {aabb.Min} - halfExtents, glm::vec2 {aabb.Max} + halfExtents, maxFraction, entryFraction))
+						{
+							continue;
+						}
+
+						float const newMaxFraction = callback(idOfSlot(m_DenseToSlot[denseIndex]), m_Colliders[denseIndex], maxFraction);
+						if (newMaxFraction <= 0.0f)
+						{
+							return;
+						}
+						maxFraction = glm::min(maxFraction, newMaxFraction);
+					}
+				}
+				return;
+			}
+		}
+
+		// The static colliders of the tree and grid broad-phases are all in the BVH.
+		if (castMaxFraction > 0.0f && !isDynamicOnly)
+		{
+			bakeStaticCollidersIfDirty();
+			m_StaticBVH.RayCast(start, displacement, halfExtents, visitProxy, filter.MaskBits, castMaxFraction);
+		}
+	}
+
+	template<typename Callback>
+	void ColliderManager::castOrientedBoxBroadPhase(OrientedBox2D const& box, glm::vec2 displacement, CollisionFilter const& filter, Callback&& callback) const
+	{
+		if (m_BroadPhaseSettings.Type != BroadPhaseType::Linear)
+		{
+			// The tree and the grid only know boxes, cast the bounds of the oriented box.
+			Math::AABB const bounds = box.GetBounds();
+			glm::vec2 const halfExtents {(bounds.Max.x - bounds.Min.x) * 0.5f, (bounds.Max.y - bounds.Min.y) * 0.5f};
+			castBroadPhase(box.Center, displacement, halfExtents, filter, callback);
+			return;
+		}
+
+		std::array<std::uint32_t, CollisionKernels::ChunkSize> candidates;
+
+		float maxFraction = 1.0f;
+		for (std::uint32_t begin = 0; begin < m_ColliderBoxes.Size(); begin += CollisionKernels::ChunkSize)
+		{
+			std::uint32_t const end = glm::min(begin + CollisionKernels::ChunkSize, m_ColliderBoxes.Size());
+			std::uint32_t const candidateCount = CollisionKernels::SweptOrientedBox(m_ColliderBoxes, begin, end, box, displacement, maxFraction, candidates.data());
+			for (std::uint32_t i = 0; i < candidateCount; i++)
+			{
+				std::uint32_t const denseIndex = candidates[i];
+				if (!isVisibleToQuery(m_Colliders[denseIndex], filter))
+				{
+					continue;
+				}
+
+				// Candidates beyond a hit found earlier in this chunk are rejected by the narrow-phase of the callback.
+				float const newMaxFraction = callback(idOfSlot(m_DenseToSlot[denseIndex]), m_Colliders[denseIndex], maxFraction);
+				if (newMaxFraction <= 0.0f)
+				{
+					return;
+				}
+				maxFraction = glm::min(maxFraction, newMaxFraction);
+			}
+		}
+	}
+
+	template<typename Callback>
+	void ColliderManager::nearestBroadPhase(glm::vec2 point, float maxDistanceSquared, CollisionFilter const& filter, Callback&& callback) const
+	{
+		auto visitProxy = [&](std::int32_t slotIndex, float currentMaxDistanceSquared)
+		{
+			Collider const& collider = m_Colliders[m_Slots[slotIndex].DenseIndexOrNextFree];
+			if (!isVisibleToQuery(collider, filter))
+			{
+				return currentMaxDistanceSquared;
+			}
+			maxDistanceSquared = glm::min(maxDistanceSquared, (float) callback(idOfSlot(slotIndex), collider, currentMaxDistanceSquared));
+			return maxDistanceSquared;
+		};
+
+		switch (m_BroadPhaseSettings.Type)
+		{
+			case BroadPhaseType::DynamicAABBTree:
+				m_AABBTree.QueryNearest(point, visitProxy, filter.MaskBits, maxDistanceSquared);
+				break;
+			case BroadPhaseType::SpatialHashGrid:
+			case BroadPhaseType::Linear:
+			{
+				// Only the bounds are read until a collider is nearer than the bound.
+				for (std::uint32_t denseIndex = 0; denseIndex < m_ColliderBounds.Size(); denseIndex++)
+				{
+					glm::vec2 const boxMin {m_ColliderBounds.MinX[denseIndex], m_ColliderBounds.MinY[denseIndex]};
+					glm::vec2 const boxMax {m_ColliderBounds.MaxX[denseIndex], m_ColliderBounds.MaxY[denseIndex]};
+					if (PointBoxDistanceSquared(point, boxMin, boxMax) > maxDistanceSquared || isInStaticBVH(m_Colliders[denseIndex]))
+					{
+						continue;
+					}
+
+					visitProxy((std::int32_t) m_DenseToSlot[denseIndex], maxDistanceSquared);
+				}
+
+				if (m_BroadPhaseSettings.Type == BroadPhaseType::Linear)
+				{
+					return;
+				}
+				break;
+			}
+		}
+
+		bakeStaticCollidersIfDirty();
+		m_StaticBVH.QueryNearest(point, visitProxy, filter.MaskBits, maxDistanceSquared);
+	}
+
+	template<typename Callback> requires OverlapCallback<Callback>
+	void ColliderManager::OverlapAABB(Math::AABB aabb, Callback&& callback, CollisionFilter filter) const
+	{
+		queryBroadPhase(aabb.Min, aabb.Max, filter, [&](ColliderID id, Collider const& collider)
+		{
+			if (!overlapCollider(collider, aabb))
+			{
+				return true;
+			}
+			return invokeOverlapCallback(callback, id, collider);
+		});
+	}
+
+	template<typename Callback> requires OverlapCallback<Callback>
+	void ColliderManager::OverlapCircle(glm::vec2 center, float radius, Callback&& callback, CollisionFilter filter) const
+	{
+		queryCircleBroadPhase(center, radius, filter, [&](ColliderID id, Collider const& collider)
+		{
+			if (!overlapCollider(collider, center, radius))
+			{
+				return true;
+			}
+			return invokeOverlapCallback(callback, id, collider);
+		});
+	}
+
+	template<typename Callback> requires std::predicate<Callback&, RaycastHit2D const&>
+	void ColliderManager::RaycastAll(glm::vec2 start, glm::vec2 end, Callback&& callback, CollisionFilter filter) const
+	{
+		glm::vec2 const direction = end - start;
+		float const maxDistance = glm::length(direction);
+
+		castBroadPhase(start, direction, {0, 0}, filter, [&](ColliderID id, Collider const& collider, float maxFraction)
+		{
+			RaycastHit2D hit;
+			if (!raycastCollider(id, collider, start, direction, maxDistance, hit))
+			{
+				return maxFraction;
+			}
+			return callback(hit)? maxFraction : 0.0f;
+		});
+	}
+
+	template<typename Callback> requires std::predicate<Callback&, RaycastHit2D const&>
+	void ColliderManager::CircleCastAll(glm::vec2 center, float radius, glm::vec2 direction, Callback&& callback, CollisionFilter filter) const
+	{
+		BroadPhaseSegment const segment = BroadPhaseSegment::Create(center, direction);
+		InflatedAABBCache const* pInflatedAABBCache = tryGetInflatedAABBCache(radius);
+
+		// Sweep the circle's bounding box through the broad-phase, the narrow-phase will reject the corner cases.
+		castBroadPhase(center, direction, {radius, radius}, filter, [&](ColliderID id, Collider const& collider, float maxFraction)
+		{
+			RaycastHit2D hit;
+			if (!circleCastCollider(id, collider, radius, segment, pInflatedAABBCache, hit))
+			{
+				return maxFraction;
+			}
+			return callback(hit)? maxFraction : 0.0f;
+		});
+	}
+
+	template<typename HitCallback> requires std::invocable<HitCallback&, RaycastHit2D const&, glm::vec2&>
+	CircleCastResolveResult ColliderManager::CircleCastResolve(glm::vec2 center, float radius, glm::vec2 velocity, float time, HitCallback&& onHit,
+															   CollisionFilter filter, std::uint32_t maxCasts) const
+	{
+		auto castCircle = [&](glm::vec2 castCenter, glm::vec2 displacement, std::span<ColliderID const> ignoredIDs)
+		{
+			return nearestCircleCast(castCenter, radius, displacement, filter, ignoredIDs);
+		};
+		return resolveCircleCasts(center, velocity, time, castCircle, onHit, maxCasts);
+	}
+
+	template<typename CastFunction, typename HitCallback>
+	CircleCastResolveResult ColliderManager::resolveCircleCasts(glm::vec2 center, glm::vec2 velocity, float time, CastFunction&& castCircle, HitCallback& onHit,
+																std::uint32_t maxCasts)
+	{
+		CircleCastResolveResult result {.Center = center, .Velocity = velocity, .HitCount = 0, .RemainingTime = time};
+		InlineVector<ColliderID, MaxResolveIgnoredColliders> ignoredIDs;
+		std::uint32_t cast = 0;
+		while (cast < maxCasts && result.RemainingTime > 0.0f)
+		{
+			glm::vec2 const displacement = result.Velocity * result.RemainingTime;
+			float const displacementLengthSquared = glm::dot(displacement, displacement);
+			if (displacementLengthSquared <= 0.0f)
+			{
+				result.RemainingTime = 0.0f;
+				break;
+			}
+
+			std::optional<RaycastHit2D> const hit = castCircle(result.Center, displacement, std::span<ColliderID const> {ignoredIDs});
+			if (!hit.has_value())
+			{
+				result.Center += displacement;
+				result.RemainingTime = 0.0f;
+				break;
+			}
+
+			// A start-inside hit has a zero normal. Like a collider the circle is already leaving, it doesn't block the circle:
+			// cast again from the same place without it. Every such collider stays ignored until the next bounce,
+			// so a circle overlapping several of them at once doesn't alternate between them.
+			bool const hasNormal = glm::dot(hit->Normal, hit->Normal) > 0.0f;
+			glm::vec2 const normal = hasNormal? glm::normalize(hit->Normal) : glm::vec2 {0, 0};
+			float const normalSpeed = glm::dot(normal, result.Velocity);
+			if (!hasNormal || normalSpeed >= 0.0f)
+			{
+				if (ignoredIDs.full())
+				{
+					break;
+				}
+				ignoredIDs.push_back(hit->ColliderID);
+				continue;
+			}
+
+			// The bounce moves the circle, so it might head back towards the colliders it was leaving.
+			ignoredIDs.clear();
+			cast++;
+
+			float const fraction = glm::clamp(hit->Time, 0.0f, 1.0f);
+			result.Center = hit->Centroid + normal * ResolveContactOffset;
+			result.RemainingTime -= fraction * result.RemainingTime;
+			result.HitCount++;
+
+			result.Velocity -= 2 * normalSpeed * normal;
+			onHit(*hit, result.Velocity);
+		}
+
+		return result;
+	}
+
+	template<typename Callback> requires std::predicate<Callback&, RaycastHit2D const&>
+	void ColliderManager::SweepAABB(Math::AABB aabb, glm::vec2 delta, Callback&& callback, CollisionFilter filter) const
+	{
+		glm::vec2 const center {(aabb.Min.x + aabb.Max.x) * 0.5f, (aabb.Min.y + aabb.Max.y) * 0.5f};
+		glm::vec2 const halfExtents {(aabb.Max.x - aabb.Min.x) * 0.5f, (aabb.Max.y - aabb.Min.y) * 0.5f};
+		BroadPhaseSegment const segment = BroadPhaseSegment::Create(center, delta);
+
+		// The broad-phase casts the same box, every candidate it returns only needs the exact slab test.
+		// Static colliders are never pushed: the static BVH isn't cast, and the linear scan drops them before the narrow-phase.
+		bool const isDynamicOnly = true;
+		castBroadPhase(center, delta, halfExtents, filter, [&](ColliderID id, Collider const& collider, float maxFraction)
+		{
+			RaycastHit2D hit;
+			if (!sweepAABBCollider(id, collider, halfExtents, segment, hit))
+			{
+				return maxFraction;
+			}
+			return callback(hit)? maxFraction : 0.0f;
+		}, isDynamicOnly);
+	}
+
+	template<typename Callback> requires std::predicate<Callback&, RaycastHit2D const&>
+	void ColliderManager::BoxCastAll(OrientedBox2D const& box, glm::vec2 direction, Callback&& callback, CollisionFilter filter) const
+	{
+		castOrientedBoxBroadPhase(box, direction, filter, [&](ColliderID id, Collider const& collider, float maxFraction)
+		{
+			RaycastHit2D hit;
+			if (!boxCastCollider(id, collider, box, direction, hit))
+			{
+				return maxFraction;
+			}
+			return callback(hit)? maxFraction : 0.0f;
+		});
+	}
 }
\ No newline at end of file
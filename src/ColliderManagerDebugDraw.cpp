@@ -0,0 +1,153 @@
+#include "ColliderManager.h"
+#include "ColliderSnapshot.h"
+#include "ImGuiPagedList.h"
+
+#include "ImGui/ImGuiUtil.h"
+#include "Graphics/DebugDraw.h"
+#include "Math/Color.h"
+
+#include <imgui.h>
+
+// The drawing code of the collider manager, kept apart so the rest builds without the window, graphics or ImGui (e.g. for the benchmarks).
+namespace DYE
+{
+	void ColliderManager::DrawGizmos() const
+	{
+		for (auto const& collider : m_Colliders)
+		{
+			drawColliderGizmo(collider);
+		}
+	}
+
+	void ColliderManager::DrawGizmos(Math::AABB const& viewBounds) const
+	{
+		glm::vec2 const viewMin {viewBounds.Min.x, viewBounds.Min.y};
+		glm::vec2 const viewMax {viewBounds.Max.x, viewBounds.Max.y};
+
+		// The tree reports the colliders by their fattened bounds, the exact test skips the ones just off screen.
+		queryBroadPhase(viewMin, viewMax, CollisionFilter::Everything(), [&](ColliderID, Collider const& collider)
+		{
+			if (isInView(collider, viewMin, viewMax))
+			{
+				drawColliderGizmo(collider);
+			}
+			return true;
+		});
+
+		// The sensors are not in the broad-phase.
+		for (Sensor const& sensor : m_Sensors)
+		{
+			Collider const& collider = m_Colliders[denseIndexOf(sensor.ID)];
+			if (isInView(collider, viewMin, viewMax))
+			{
+				drawColliderGizmo(collider);
+			}
+		}
+	}
+
+	void ColliderManager::drawColliderGizmo(Collider const& collider)
+	{
+		glm::vec4 const color = collider.IsSensor? Color::Yellow : Color::Blue;
+		if (!collider.IsOriented)
+		{
+			DebugDraw::AABB(collider.AABB.Min, collider.AABB.Max, color);
+			return;
+		}
+
+		OrientedBox2D const& box = collider.OrientedBox;
+		std::array<glm::vec2, 4> const corners
+		{
+			box.ToWorldPoint({-box.HalfExtents.x, -box.HalfExtents.y}),
+			box.ToWorldPoint({box.HalfExtents.x, -box.HalfExtents.y}),
+			box.ToWorldPoint({box.HalfExtents.x, box.HalfExtents.y}),
+			box.ToWorldPoint({-box.HalfExtents.x, box.HalfExtents.y})
+		};
+		for (std::size_t i = 0; i < corners.size(); i++)
+		{
+			glm::vec2 const next = corners[(i + 1) % corners.size()];
+			DebugDraw::Line(glm::vec3 {corners[i], 0}, glm::vec3 {next, 0}, color);
+		}
+	}
+
+	void ColliderManager::DrawImGui()
+	{
+		if (ImGui::Begin("Collider Manager"))
+		{
+			ImGui::Text("%d colliders", (int) m_Colliders.size());
+			ImGui::InputInt("Find Slot Index (-1 for all)", &m_InspectorSlotFilter);
+
+			// Without a filter the clipper indexes the dense colliders directly, nothing is built for the rows that aren't visible.
+			bool const isFiltered = m_InspectorSlotFilter >= 0;
+			std::uint32_t const filterSlotIndex = (std::uint32_t) m_InspectorSlotFilter;
+			bool const isFilterFound = isFiltered && filterSlotIndex < m_Slots.size() && m_Slots[filterSlotIndex].IsInUse;
+			std::size_t const rowCount = isFiltered? (isFilterFound? 1 : 0) : m_Colliders.size();
+
+			ImGuiPagedList::Draw("Colliders", rowCount, m_InspectorPage, [&](std::uint32_t rowIndex)
+			{
+				// Keyed by slot: unregistering a collider moves another one to its dense index, its widgets must not follow.
+				std::uint32_t const slotIndex = isFiltered? filterSlotIndex : m_DenseToSlot[rowIndex];
+				ImGui::PushID((int) slotIndex);
+				drawColliderInspectorRow(slotIndex);
+				ImGui::PopID();
+			});
+		}
+
+		ImGui::End();
+	}
+
+	void ColliderManager::drawColliderInspectorRow(std::uint32_t slotIndex)
+	{
+		ColliderID const id = idOfSlot(slotIndex);
+		Collider const& collider = m_Colliders[m_Slots[slotIndex].DenseIndexOrNextFree];
+
+		if (collider.IsOriented)
+		{
+			// The AABB control would drop the rotation, show the box read-only.
+			// Two controls like the Min and Max of the AABB control, so the rows keep the same height for the clipper.
+			OrientedBox2D box = collider.OrientedBox;
+			ImGui::Text("Collider %u:%u%s, oriented %.1f degrees, read-only", id.Index, id.Generation, collider.IsSensor? " (sensor)" : "",
+						glm::degrees(box.GetRotation()));
+			ImGui::BeginDisabled();
+			ImGuiUtil::DrawVector2Control("Center", box.Center);
+			ImGuiUtil::DrawVector2Control("Half Extents", box.HalfExtents);
+			ImGui::EndDisabled();
+			return;
+		}
+
+		ImGui::Text("Collider %u:%u%s", id.Index, id.Generation, collider.IsSensor? " (sensor)" : "");
+
+		// Edit a copy so the broad-phase can be notified of the change through SetAABB.
+		Math::AABB aabb = collider.AABB;
+		ImGuiUtil::DrawAABBControl("AABB", aabb);
+
+		bool const isChanged = aabb.Min != collider.AABB.Min || aabb.Max != collider.AABB.Max;
+		if (isChanged)
+		{
+			SetAABB(id, aabb);
+		}
+	}
+
+	void ColliderManager::Snapshot::DrawGizmos() const
+	{
+		for (std::uint32_t slotIndex = 0; slotIndex < m_Generations.size(); slotIndex++)
+		{
+			if (m_Generations[slotIndex] != 0)
+			{
+				drawColliderGizmo(m_Colliders[slotIndex]);
+			}
+		}
+	}
+
+	void ColliderManager::Snapshot::DrawGizmos(Math::AABB const& viewBounds) const
+	{
+		glm::vec2 const viewMin {viewBounds.Min.x, viewBounds.Min.y};
+		glm::vec2 const viewMax {viewBounds.Max.x, viewBounds.Max.y};
+		for (std::uint32_t slotIndex = 0; slotIndex < m_Generations.size(); slotIndex++)
+		{
+			if (m_Generations[slotIndex] != 0 && isInView(m_Colliders[slotIndex], viewMin, viewMax))
+			{
+				drawColliderGizmo(m_Colliders[slotIndex]);
+			}
+		}
+	}
+}
\ No newline at end of file
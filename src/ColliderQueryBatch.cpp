@@ -0,0 +1,128 @@
+#include "ColliderQueryBatch.h"
+
+namespace DYE
+{
+	ColliderManager::QueryBatch::QueryBatch(ColliderManager const& colliderManager) : m_ColliderManager(colliderManager)
+	{
+	}
+
+	ColliderManager::QueryBatch::QueryIndex ColliderManager::QueryBatch::AddOverlapAABB(Math::AABB aabb, CollisionFilter filter)
+	{
+		Query& query = addQuery(QueryType::OverlapAABB, filter);
+		query.AABB = aabb;
+		return m_QueryCount - 1;
+	}
+
+	ColliderManager::QueryBatch::QueryIndex ColliderManager::QueryBatch::AddOverlapCircle(glm::vec2 center, float radius, CollisionFilter filter)
+	{
+		Query& query = addQuery(QueryType::OverlapCircle, filter);
+		query.Origin = center;
+		query.Radius = radius;
+		return m_QueryCount - 1;
+	}
+
+	ColliderManager::QueryBatch::QueryIndex ColliderManager::QueryBatch::AddRaycastAll(glm::vec2 start, glm::vec2 end, CollisionFilter filter)
+	{
+		Query& query = addQuery(QueryType::RaycastAll, filter);
+		query.Origin = start;
+		query.EndOrDirection = end;
+		return m_QueryCount - 1;
+	}
+
+	ColliderManager::QueryBatch::QueryIndex ColliderManager::QueryBatch::AddCircleCastAll(glm::vec2 center, float radius, glm::vec2 direction, CollisionFilter filter)
+	{
+		Query& query = addQuery(QueryType::CircleCastAll, filter);
+		query.Origin = center;
+		query.Radius = radius;
+		query.EndOrDirection = direction;
+		return m_QueryCount - 1;
+	}
+
+	ColliderManager::QueryBatch::QueryIndex ColliderManager::QueryBatch::AddRaycast(glm::vec2 start, glm::vec2 end, CollisionFilter filter)
+	{
+		Query& query = addQuery(QueryType::Raycast, filter);
+		query.Origin = start;
+		query.EndOrDirection = end;
+		return m_QueryCount - 1;
+	}
+
+	ColliderManager::QueryBatch::QueryIndex ColliderManager::QueryBatch::AddCircleCast(glm::vec2 center, float radius, glm::vec2 direction, CollisionFilter filter)
+	{
+		Query& query = addQuery(QueryType::CircleCast, filter);
+		query.Origin = center;
+		query.Radius = radius;
+		query.EndOrDirection = direction;
+		return m_QueryCount - 1;
+	}
+
+	void ColliderManager::QueryBatch::Execute()
+	{
+		for (std::uint32_t i = 0; i < m_QueryCount; i++)
+		{
+			executeQuery(m_Queries[i]);
+		}
+	}
+
+	void ColliderManager::QueryBatch::Execute(WorkerThreadPool& threadPool)
+	{
+		// Each query only writes to its own result buffers, so the order the queries are run in doesn't matter.
+		threadPool.ParallelFor(m_QueryCount, QueriesPerBatch, [this](std::uint32_t queryIndex)
+		{
+			executeQuery(m_Queries[queryIndex]);
+		});
+	}
+
+	ColliderManager::QueryBatch::Query& ColliderManager::QueryBatch::addQuery(QueryType type, CollisionFilter const& filter)
+	{
+		if (m_QueryCount == m_Queries.size())
+		{
+			m_Queries.emplace_back();
+		}
+
+		Query& query = m_Queries[m_QueryCount];
+		query.Type = type;
+		query.Filter = filter;
+		query.Overlaps.clear();
+		query.Hits.clear();
+
+		m_QueryCount++;
+		return query;
+	}
+
+	void ColliderManager::QueryBatch::executeQuery(Query& query) const
+	{
+		switch (query.Type)
+		{
+			case QueryType::OverlapAABB:
+				m_ColliderManager.OverlapAABB(query.AABB, query.Overlaps, query.Filter);
+				break;
+			case QueryType::OverlapCircle:
+				m_ColliderManager.OverlapCircle(query.Origin, query.Radius, query.Overlaps, query.Filter);
+				break;
+			case QueryType::RaycastAll:
+				m_ColliderManager.RaycastAll(query.Origin, query.EndOrDirection, query.Hits, query.Filter);
+				break;
+			case QueryType::CircleCastAll:
+				m_ColliderManager.CircleCastAll(query.Origin, query.Radius, query.EndOrDirection, query.Hits, query.Filter);
+				break;
+			case QueryType::Raycast:
+			{
+				std::optional<RaycastHit2D> const hit = m_ColliderManager.Raycast(query.Origin, query.EndOrDirection, query.Filter);
+				if (hit.has_value())
+				{
+					query.Hits.push_back(hit.value());
+				}
+				break;
+			}
+			case QueryType::CircleCast:
+			{
+				std::optional<RaycastHit2D> const hit = m_ColliderManager.CircleCast(query.Origin, query.Radius, query.EndOrDirection, query.Filter);
+				if (hit.has_value())
+				{
+					query.Hits.push_back(hit.value());
+				}
+				break;
+			}
+		}
+	}
+}
\ No newline at end of file
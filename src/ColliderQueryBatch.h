@@ -0,0 +1,93 @@
+#pragma once
+
+#include "src/ColliderManager.h"
+#include "src/WorkerThreadPool.h"
+
+#include <span>
+#include <vector>
+
+namespace DYE
+{
+	/// Record overlap, ray and circle-cast queries during an update, then run them all with one Execute() call.
+	/// The queries only read the collider manager, so they can be spread across worker threads;
+	/// the manager must not be modified while Execute() is running.
+	/// Every query is run exactly like its ColliderManager counterpart, so the results are identical to serial execution.
+	/// The batch reads the live manager rather than a frozen copy: a copy would have to duplicate the broad-phase, the static BVH
+	/// and the SIMD streams on every batch, O(colliders) work for batches that usually hold a few dozen queries.
+	/// Execute() is a synchronization point instead, the gameplay resumes modifying the colliders once it returns.
+	/// A ColliderManager::Snapshot is the frozen copy to hand to other threads, it is read without locks but has no queries.
+	class ColliderManager::QueryBatch
+	{
+	public:
+		using QueryIndex = std::uint32_t;
+
+		explicit QueryBatch(ColliderManager const& colliderManager);
+
+		/// \return the index of the query, used to read its results after Execute().
+		QueryIndex AddOverlapAABB(Math::AABB aabb, CollisionFilter filter = CollisionFilter::Everything());
+		QueryIndex AddOverlapCircle(glm::vec2 center, float radius, CollisionFilter filter = CollisionFilter::Everything());
+		QueryIndex AddRaycastAll(glm::vec2 start, glm::vec2 end, CollisionFilter filter = CollisionFilter::Everything());
+		QueryIndex AddCircleCastAll(glm::vec2 center, float radius, glm::vec2 direction, CollisionFilter filter = CollisionFilter::Everything());
+
+		/// First hit only, the results of the query have at most one hit.
+		QueryIndex AddRaycast(glm::vec2 start, glm::vec2 end, CollisionFilter filter = CollisionFilter::Everything());
+		QueryIndex AddCircleCast(glm::vec2 center, float radius, glm::vec2 direction, CollisionFilter filter = CollisionFilter::Everything());
+
+		/// Run the recorded queries on the calling thread.
+		void Execute();
+
+		/// Run the recorded queries across the workers of the pool, the calling thread takes part as well.
+		void Execute(WorkerThreadPool& threadPool);
+
+		std::uint32_t GetQueryCount() const { return m_QueryCount; }
+
+		/// The colliders found by an overlap query, in the same order as ColliderManager::OverlapAABB/OverlapCircle.
+		std::span<ColliderID const> GetOverlaps(QueryIndex queryIndex) const { return m_Queries[queryIndex].Overlaps; }
+
+		/// The hits of a cast query, ordered by time.
+		std::span<RaycastHit2D const> GetHits(QueryIndex queryIndex) const { return m_Queries[queryIndex].Hits; }
+
+		/// Forget the recorded queries, the result buffers are kept to be reused by the next batch.
+		void Clear() { m_QueryCount = 0; }
+
+	private:
+		enum class QueryType
+		{
+			OverlapAABB,
+			OverlapCircle,
+			RaycastAll,
+			CircleCastAll,
+			Raycast,
+			CircleCast
+		};
+
+		struct Query
+		{
+			QueryType Type;
+
+			Math::AABB AABB;
+			glm::vec2 Origin;
+			// The end point of a ray, or the displacement of a circle cast.
+			glm::vec2 EndOrDirection;
+			float Radius;
+			CollisionFilter Filter;
+
+			std::vector<ColliderID> Overlaps;
+			std::vector<RaycastHit2D> Hits;
+		};
+
+		Query& addQuery(QueryType type, CollisionFilter const& filter);
+		void executeQuery(Query& query) const;
+
+	private:
+		// Queries processed per batch claimed by a worker, large enough to amortize the claim.
+		constexpr static std::uint32_t QueriesPerBatch = 16;
+
+		// Live, not a copy, see the class comment.
+		ColliderManager const& m_ColliderManager;
+
+		// Query objects past m_QueryCount are kept around so their result buffers can be reused.
+		std::vector<Query> m_Queries;
+		std::uint32_t m_QueryCount = 0;
+	};
+}
\ No newline at end of file
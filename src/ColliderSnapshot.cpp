@@ -0,0 +1,65 @@
+#include "ColliderSnapshot.h"
+
+namespace DYE
+{
+	std::optional<Math::AABB> ColliderManager::Snapshot::GetAABB(ColliderID id) const
+	{
+		Collider const* pCollider = tryGetCollider(id);
+		if (pCollider == nullptr)
+		{
+			return {};
+		}
+
+		return pCollider->AABB;
+	}
+
+	std::optional<OrientedBox2D> ColliderManager::Snapshot::GetOBB(ColliderID id) const
+	{
+		Collider const* pCollider = tryGetCollider(id);
+		if (pCollider == nullptr)
+		{
+			return {};
+		}
+
+		return pCollider->OrientedBox;
+	}
+
+	std::optional<CollisionFilter> ColliderManager::Snapshot::GetCollisionFilter(ColliderID id) const
+	{
+		Collider const* pCollider = tryGetCollider(id);
+		if (pCollider == nullptr)
+		{
+			return {};
+		}
+
+		return pCollider->Filter;
+	}
+
+	std::optional<ColliderUserData> ColliderManager::Snapshot::GetUserData(ColliderID id) const
+	{
+		Collider const* pCollider = tryGetCollider(id);
+		if (pCollider == nullptr)
+		{
+			return {};
+		}
+
+		return pCollider->UserData;
+	}
+
+	std::optional<glm::vec2> ColliderManager::Snapshot::GetVelocity(ColliderID id) const
+	{
+		Collider const* pCollider = tryGetCollider(id);
+		if (pCollider == nullptr)
+		{
+			return {};
+		}
+
+		return pCollider->Velocity;
+	}
+
+	bool ColliderManager::Snapshot::IsSensor(ColliderID id) const
+	{
+		Collider const* pCollider = tryGetCollider(id);
+		return pCollider != nullptr && pCollider->IsSensor;
+	}
+}
\ No newline at end of file
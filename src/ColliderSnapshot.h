@@ -0,0 +1,71 @@
+#pragma once
+
+#include "src/ColliderManager.h"
+
+#include <optional>
+#include <vector>
+
+namespace DYE
+{
+	/// An immutable copy of the colliders of a ColliderManager, taken by ColliderManager::PublishSnapshot().
+	/// A snapshot never changes once published, so any number of threads (e.g. a render thread drawing the gizmos)
+	/// can read it without locks while the manager keeps being modified and the next snapshot is prepared.
+	/// Hold it only for as long as it is read: the manager recycles its snapshots, and has to copy every collider
+	/// instead of only the changed ones if a reader still holds the snapshot being recycled.
+	class ColliderManager::Snapshot
+	{
+		friend class ColliderManager;
+
+	public:
+		/// The number of snapshots the manager had published when this one was, starting from 1.
+		std::uint64_t GetEpoch() const { return m_Epoch; }
+		std::size_t GetColliderCount() const { return m_ColliderCount; }
+
+		bool IsColliderRegistered(ColliderID id) const { return tryGetCollider(id) != nullptr; }
+		std::optional<Math::AABB> GetAABB(ColliderID id) const;
+		std::optional<OrientedBox2D> GetOBB(ColliderID id) const;
+		std::optional<CollisionFilter> GetCollisionFilter(ColliderID id) const;
+		std::optional<ColliderUserData> GetUserData(ColliderID id) const;
+		std::optional<glm::vec2> GetVelocity(ColliderID id) const;
+		bool IsSensor(ColliderID id) const;
+
+		/// Visit every collider in the snapshot, in slot order.
+		/// \param callback void(ColliderID id, Math::AABB const& aabb, ColliderUserData userData), the AABB is the bounds of an oriented collider.
+		template<typename Callback>
+		void ForEachCollider(Callback&& callback) const
+		{
+			for (std::uint32_t slotIndex = 0; slotIndex < m_Generations.size(); slotIndex++)
+			{
+				if (m_Generations[slotIndex] != 0)
+				{
+					callback(ColliderID {slotIndex, m_Generations[slotIndex]}, m_Colliders[slotIndex].AABB, m_Colliders[slotIndex].UserData);
+				}
+			}
+		}
+
+		void DrawGizmos() const;
+		/// Only draw the colliders overlapping the view bounds. A snapshot has no broad-phase, every collider is tested.
+		void DrawGizmos(Math::AABB const& viewBounds) const;
+
+	private:
+		Snapshot() = default;
+
+		Collider const* tryGetCollider(ColliderID id) const
+		{
+			if (id.Index >= m_Generations.size() || m_Generations[id.Index] == 0 || m_Generations[id.Index] != id.Generation)
+			{
+				return nullptr;
+			}
+			return &m_Colliders[id.Index];
+		}
+
+	private:
+		std::uint64_t m_Epoch = 0;
+		std::size_t m_ColliderCount = 0;
+
+		// Indexed by slot rather than packed like the manager, so a changed collider is copied in place.
+		std::vector<Collider> m_Colliders;
+		// The generation of the collider in each slot, 0 if the slot is free. A slot in use never has generation 0, it is retired on wrap-around.
+		std::vector<std::uint32_t> m_Generations;
+	};
+}
\ No newline at end of file
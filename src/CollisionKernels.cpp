@@ -0,0 +1,838 @@
+#include "CollisionKernels.h"
+
+#include <bit>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define DYE_COLLISION_KERNELS_X86
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#endif
+#endif
+
+// GCC and Clang only emit AVX2 instructions in functions that opt in, so the rest of the binary still runs on older CPUs.
+#if defined(__GNUC__) || defined(__clang__)
+	#define DYE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+	#define DYE_TARGET_AVX2
+#endif
+
+namespace DYE::CollisionKernels
+{
+	namespace
+	{
+		// Padding added to the circle radius (relative) and to the swept extents,
+		// so rounding differences with Math::PrimitiveTest never reject a grazing hit.
+		constexpr float RadiusTolerance = 0.0001f;
+		constexpr float SweepTolerance = 0.0001f;
+
+		float paddedRadiusSquared(float radius)
+		{
+			float const paddedRadius = radius * (1.0f + RadiusTolerance) + RadiusTolerance;
+			return paddedRadius * paddedRadius;
+		}
+
+		glm::vec2 paddedSweepExtents(glm::vec2 halfExtents)
+		{
+			float const padding = SweepTolerance * (1.0f + glm::max(halfExtents.x, halfExtents.y));
+			return halfExtents + glm::vec2 {padding, padding};
+		}
+
+		/// An axis with no displacement gets a huge inverse instead of infinity, like RayPacket::AddRay.
+		float safeInverse(float value)
+		{
+			constexpr float hugeInverse = 1e30f;
+			return value == 0.0f? hugeInverse : 1.0f / value;
+		}
+
+		/// The parts of a swept oriented box test that don't depend on the tested box.
+		struct SweptOrientedBoxQuery
+		{
+			glm::vec2 Center;
+			glm::vec2 HalfExtents;
+			glm::vec2 AxisX;
+			glm::vec2 Displacement;
+			// The inverse of the displacement projected on the two axes of the query box.
+			glm::vec2 InverseSpeed;
+			float MaxFraction;
+		};
+
+		bool isAVX2SupportedByCPU()
+		{
+#if !defined(DYE_COLLISION_KERNELS_X86)
+			return false;
+#elif defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7)
+			{
+				return false;
+			}
+
+			// The OS has to save the YMM registers on context switches as well.
+			__cpuid(info, 1);
+			bool const hasOSXSave = (info[2] & (1 << 27)) != 0;
+			bool const hasAVX = (info[2] & (1 << 28)) != 0;
+			if (!hasOSXSave || !hasAVX || (_xgetbv(0) & 0x6) != 0x6)
+			{
+				return false;
+			}
+
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+#else
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2");
+#endif
+		}
+
+		// Scalar kernels, also used for the tail of a chunk that doesn't fill a whole vector.
+
+		std::uint32_t overlapBoxScalar(AABBStreams const& streams, std::uint32_t begin, std::uint32_t end,
+									   glm::vec2 min, glm::vec2 max, std::uint32_t* outIndices, std::uint32_t count)
+		{
+			for (std::uint32_t i = begin; i < end; i++)
+			{
+				bool const isOverlapped = streams.MinX[i] <= max.x && streams.MaxX[i] >= min.x &&
+										  streams.MinY[i] <= max.y && streams.MaxY[i] >= min.y;
+				if (isOverlapped)
+				{
+					outIndices[count] = i;
+					count++;
+				}
+			}
+
+			return count;
+		}
+
+		std::uint32_t overlapCircleScalar(AABBStreams const& streams, std::uint32_t begin, std::uint32_t end,
+										  glm::vec2 center, float radiusSquared, std::uint32_t* outIndices, std::uint32_t count)
+		{
+			for (std::uint32_t i = begin; i < end; i++)
+			{
+				// Distance from the center to the closest point of the box on each axis, 0 if the center is within the slab.
+				float const dx = glm::max(glm::max(streams.MinX[i] - center.x, center.x - streams.MaxX[i]), 0.0f);
+				float const dy = glm::max(glm::max(streams.MinY[i] - center.y, center.y - streams.MaxY[i]), 0.0f);
+				if (dx * dx + dy * dy <= radiusSquared)
+				{
+					outIndices[count] = i;
+					count++;
+				}
+			}
+
+			return count;
+		}
+
+		std::uint32_t sweptBoxScalar(AABBStreams const& streams, std::uint32_t begin, std::uint32_t end,
+									 BroadPhaseSegment const& segment, glm::vec2 extents, float maxFraction,
+									 std::uint32_t* outIndices, std::uint32_t count)
+		{
+			for (std::uint32_t i = begin; i < end; i++)
+			{
+				float const minX = streams.MinX[i] - extents.x;
+				float const maxX = streams.MaxX[i] + extents.x;
+				float const minY = streams.MinY[i] - extents.y;
+				float const maxY = streams.MaxY[i] + extents.y;
+
+				float tMin = 0.0f;
+				float tMax = maxFraction;
+				bool isInsideSlabs = true;
+
+				if (segment.IsParallelX)
+				{
+					isInsideSlabs = isInsideSlabs && segment.Start.x >= minX && segment.Start.x <= maxX;
+				}
+				else
+				{
+					float const t1 = (minX - segment.Start.x) * segment.InverseDisplacement.x;
+					float const t2 = (maxX - segment.Start.x) * segment.InverseDisplacement.x;
+					tMin = glm::max(tMin, glm::min(t1, t2));
+					tMax = glm::min(tMax, glm::max(t1, t2));
+				}
+
+				if (segment.IsParallelY)
+				{
+					isInsideSlabs = isInsideSlabs && segment.Start.y >= minY && segment.Start.y <= maxY;
+				}
+				else
+				{
+					float const t1 = (minY - segment.Start.y) * segment.InverseDisplacement.y;
+					float const t2 = (maxY - segment.Start.y) * segment.InverseDisplacement.y;
+					tMin = glm::max(tMin, glm::min(t1, t2));
+					tMax = glm::min(tMax, glm::max(t1, t2));
+				}
+
+				if (isInsideSlabs && tMin <= tMax)
+				{
+					outIndices[count] = i;
+					count++;
+				}
+			}
+
+			return count;
+		}
+
+		/// Clip [tMin, tMax] to the interval during which the projections on one axis overlap.
+		/// The radius is the sum of the projected radii of both boxes, the distance is the projected offset from the query box to the tested box.
+		void clipSeparatingAxis(float distance, float radius, float inverseSpeed, float& tMin, float& tMax)
+		{
+			float const paddedRadius = radius * (1.0f + SweepTolerance) + SweepTolerance;
+			float const t1 = (distance - paddedRadius) * inverseSpeed;
+			float const t2 = (distance + paddedRadius) * inverseSpeed;
+			tMin = glm::max(tMin, glm::min(t1, t2));
+			tMax = glm::min(tMax, glm::max(t1, t2));
+		}
+
+		std::uint32_t sweptOrientedBoxScalar(OrientedBoxStreams const& streams, std::uint32_t begin, std::uint32_t end,
+											 SweptOrientedBoxQuery const& query, std::uint32_t* outIndices, std::uint32_t count)
+		{
+			glm::vec2 const axis = query.AxisX;
+			glm::vec2 const halfExtents = query.HalfExtents;
+
+			for (std::uint32_t i = begin; i < end; i++)
+			{
+				float const offsetX = streams.CenterX[i] - query.Center.x;
+				float const offsetY = streams.CenterY[i] - query.Center.y;
+				float const axisX = streams.AxisX[i];
+				float const axisY = streams.AxisY[i];
+				float const halfExtentX = streams.HalfExtentX[i];
+				float const halfExtentY = streams.HalfExtentY[i];
+
+				// |cos| and |sin| of the angle between the two boxes, they give every projected radius.
+				float const cosine = glm::abs(axis.x * axisX + axis.y * axisY);
+				float const sine = glm::abs(axis.y * axisX - axis.x * axisY);
+
+				float tMin = 0.0f;
+				float tMax = query.MaxFraction;
+
+				// The axes of the query box.
+				clipSeparatingAxis(offsetX * axis.x + offsetY * axis.y,
+								   halfExtents.x + halfExtentX * cosine + halfExtentY * sine, query.InverseSpeed.x, tMin, tMax);
+				clipSeparatingAxis(offsetY * axis.x - offsetX * axis.y,
+								   halfExtents.y + halfExtentX * sine + halfExtentY * cosine, query.InverseSpeed.y, tMin, tMax);
+
+				// The axes of the tested box.
+				clipSeparatingAxis(offsetX * axisX + offsetY * axisY,
+								   halfExtentX + halfExtents.x * cosine + halfExtents.y * sine,
+								   safeInverse(query.Displacement.x * axisX + query.Displacement.y * axisY), tMin, tMax);
+				clipSeparatingAxis(offsetY * axisX - offsetX * axisY,
+								   halfExtentY + halfExtents.x * sine + halfExtents.y * cosine,
+								   safeInverse(query.Displacement.y * axisX - query.Displacement.x * axisY), tMin, tMax);
+
+				if (tMin <= tMax)
+				{
+					outIndices[count] = i;
+					count++;
+				}
+			}
+
+			return count;
+		}
+
+		std::uint32_t rayPacketBoxScalar(RayPacket const& packet, glm::vec2 boxMin, glm::vec2 boxMax)
+		{
+			std::uint32_t hitMask = 0;
+			for (std::uint32_t ray = 0; ray < packet.RayCount; ray++)
+			{
+				float const tx1 = (boxMin.x - packet.Start.x) * packet.InverseDisplacementX[ray];
+				float const tx2 = (boxMax.x - packet.Start.x) * packet.InverseDisplacementX[ray];
+				float const ty1 = (boxMin.y - packet.Start.y) * packet.InverseDisplacementY[ray];
+				float const ty2 = (boxMax.y - packet.Start.y) * packet.InverseDisplacementY[ray];
+
+				float const tMin = glm::max(glm::max(glm::min(tx1, tx2), glm::min(ty1, ty2)), 0.0f);
+				float const tMax = glm::min(glm::min(glm::max(tx1, tx2), glm::max(ty1, ty2)), packet.MaxFraction[ray]);
+				if (tMin <= tMax)
+				{
+					hitMask |= 1u << ray;
+				}
+			}
+
+			return hitMask;
+		}
+
+		/// Append the indices of the set bits of the lane mask.
+		/// Most lanes miss, so the vector loops only call this for non-zero masks,
+		/// which also keeps the AVX2 loops from paying for the transition back to SSE code on every iteration.
+		std::uint32_t appendLanes(std::uint32_t laneMask, std::uint32_t firstIndex, std::uint32_t* outIndices, std::uint32_t count)
+		{
+			while (laneMask != 0)
+			{
+				outIndices[count] = firstIndex + (std::uint32_t) std::countr_zero(laneMask);
+				count++;
+				laneMask &= laneMask - 1;
+			}
+
+			return count;
+		}
+
+#if defined(DYE_COLLISION_KERNELS_X86)
+		// SSE kernels, SSE2 is always available on x64 so they don't need a runtime check.
+
+		std::uint32_t overlapBoxSSE(AABBStreams const& streams, std::uint32_t begin, std::uint32_t end,
+									glm::vec2 min, glm::vec2 max, std::uint32_t* outIndices)
+		{
+			__m128 const queryMinX = _mm_set1_ps(min.x);
+			__m128 const queryMinY = _mm_set1_ps(min.y);
+			__m128 const queryMaxX = _mm_set1_ps(max.x);
+			__m128 const queryMaxY = _mm_set1_ps(max.y);
+
+			std::uint32_t count = 0;
+			std::uint32_t i = begin;
+			for (; i + 4 <= end; i += 4)
+			{
+				__m128 overlap = _mm_cmple_ps(_mm_loadu_ps(&streams.MinX[i]), queryMaxX);
+				overlap = _mm_and_ps(overlap, _mm_cmpge_ps(_mm_loadu_ps(&streams.MaxX[i]), queryMinX));
+				overlap = _mm_and_ps(overlap, _mm_cmple_ps(_mm_loadu_ps(&streams.MinY[i]), queryMaxY));
+				overlap = _mm_and_ps(overlap, _mm_cmpge_ps(_mm_loadu_ps(&streams.MaxY[i]), queryMinY));
+
+				std::uint32_t const laneMask = (std::uint32_t) _mm_movemask_ps(overlap);
+				if (laneMask != 0)
+				{
+					count = appendLanes(laneMask, i, outIndices, count);
+				}
+			}
+
+			return overlapBoxScalar(streams, i, end, min, max, outIndices, count);
+		}
+
+		std::uint32_t overlapCircleSSE(AABBStreams const& streams, std::uint32_t begin, std::uint32_t end,
+									   glm::vec2 center, float radiusSquared, std::uint32_t* outIndices)
+		{
+			__m128 const centerX = _mm_set1_ps(center.x);
+			__m128 const centerY = _mm_set1_ps(center.y);
+			__m128 const maxDistanceSquared = _mm_set1_ps(radiusSquared);
+			__m128 const zero = _mm_setzero_ps();
+
+			std::uint32_t count = 0;
+			std::uint32_t i = begin;
+			for (; i + 4 <= end; i += 4)
+			{
+				__m128 const dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&streams.MinX[i]), centerX),
+														_mm_sub_ps(centerX, _mm_loadu_ps(&streams.MaxX[i]))), zero);
+				__m128 const dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&streams.MinY[i]), centerY),
+														_mm_sub_ps(centerY, _mm_loadu_ps(&streams.MaxY[i]))), zero);
+				__m128 const distanceSquared = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+
+				std::uint32_t const laneMask = (std::uint32_t) _mm_movemask_ps(_mm_cmple_ps(distanceSquared, maxDistanceSquared));
+				if (laneMask != 0)
+				{
+					count = appendLanes(laneMask, i, outIndices, count);
+				}
+			}
+
+			return overlapCircleScalar(streams, i, end, center, radiusSquared, outIndices, count);
+		}
+
+		std::uint32_t sweptBoxSSE(AABBStreams const& streams, std::uint32_t begin, std::uint32_t end,
+								  BroadPhaseSegment const& segment, glm::vec2 extents, float maxFraction, std::uint32_t* outIndices)
+		{
+			__m128 const startX = _mm_set1_ps(segment.Start.x);
+			__m128 const startY = _mm_set1_ps(segment.Start.y);
+			__m128 const inverseDisplacementX = _mm_set1_ps(segment.InverseDisplacement.x);
+			__m128 const inverseDisplacementY = _mm_set1_ps(segment.InverseDisplacement.y);
+			__m128 const extentsX = _mm_set1_ps(extents.x);
+			__m128 const extentsY = _mm_set1_ps(extents.y);
+			__m128 const zero = _mm_setzero_ps();
+			__m128 const maxFractions = _mm_set1_ps(maxFraction);
+
+			std::uint32_t count = 0;
+			std::uint32_t i = begin;
+			for (; i + 4 <= end; i += 4)
+			{
+				__m128 const minX = _mm_sub_ps(_mm_loadu_ps(&streams.MinX[i]), extentsX);
+				__m128 const maxX = _mm_add_ps(_mm_loadu_ps(&streams.MaxX[i]), extentsX);
+				__m128 const minY = _mm_sub_ps(_mm_loadu_ps(&streams.MinY[i]), extentsY);
+				__m128 const maxY = _mm_add_ps(_mm_loadu_ps(&streams.MaxY[i]), extentsY);
+
+				__m128 tMin = zero;
+				__m128 tMax = maxFractions;
+				__m128 isInsideSlabs = _mm_cmpeq_ps(zero, zero);
+
+				if (segment.IsParallelX)
+				{
+					isInsideSlabs = _mm_and_ps(isInsideSlabs, _mm_and_ps(_mm_cmpge_ps(startX, minX), _mm_cmple_ps(startX, maxX)));
+				}
+				else
+				{
+					__m128 const t1 = _mm_mul_ps(_mm_sub_ps(minX, startX), inverseDisplacementX);
+					__m128 const t2 = _mm_mul_ps(_mm_sub_ps(maxX, startX), inverseDisplacementX);
+					tMin = _mm_max_ps(tMin, _mm_min_ps(t1, t2));
+					tMax = _mm_min_ps(tMax, _mm_max_ps(t1, t2));
+				}
+
+				if (segment.IsParallelY)
+				{
+					isInsideSlabs = _mm_and_ps(isInsideSlabs, _mm_and_ps(_mm_cmpge_ps(startY, minY), _mm_cmple_ps(startY, maxY)));
+				}
+				else
+				{
+					__m128 const t1 = _mm_mul_ps(_mm_sub_ps(minY, startY), inverseDisplacementY);
+					__m128 const t2 = _mm_mul_ps(_mm_sub_ps(maxY, startY), inverseDisplacementY);
+					tMin = _mm_max_ps(tMin, _mm_min_ps(t1, t2));
+					tMax = _mm_min_ps(tMax, _mm_max_ps(t1, t2));
+				}
+
+				__m128 const isHit = _mm_and_ps(isInsideSlabs, _mm_cmple_ps(tMin, tMax));
+				std::uint32_t const laneMask = (std::uint32_t) _mm_movemask_ps(isHit);
+				if (laneMask != 0)
+				{
+					count = appendLanes(laneMask, i, outIndices, count);
+				}
+			}
+
+			return sweptBoxScalar(streams, i, end, segment, extents, maxFraction, outIndices, count);
+		}
+
+		void clipSeparatingAxisSSE(__m128 distance, __m128 radius, __m128 inverseSpeed, __m128& tMin, __m128& tMax)
+		{
+			__m128 const paddedRadius = _mm_add_ps(_mm_mul_ps(radius, _mm_set1_ps(1.0f + SweepTolerance)), _mm_set1_ps(SweepTolerance));
+			__m128 const t1 = _mm_mul_ps(_mm_sub_ps(distance, paddedRadius), inverseSpeed);
+			__m128 const t2 = _mm_mul_ps(_mm_add_ps(distance, paddedRadius), inverseSpeed);
+			tMin = _mm_max_ps(tMin, _mm_min_ps(t1, t2));
+			tMax = _mm_min_ps(tMax, _mm_max_ps(t1, t2));
+		}
+
+		__m128 safeInverseSSE(__m128 value)
+		{
+			__m128 const isZero = _mm_cmpeq_ps(value, _mm_setzero_ps());
+			__m128 const inverse = _mm_div_ps(_mm_set1_ps(1.0f), value);
+			return _mm_or_ps(_mm_and_ps(isZero, _mm_set1_ps(1e30f)), _mm_andnot_ps(isZero, inverse));
+		}
+
+		std::uint32_t sweptOrientedBoxSSE(OrientedBoxStreams const& streams, std::uint32_t begin, std::uint32_t end,
+										  SweptOrientedBoxQuery const& query, std::uint32_t* outIndices)
+		{
+			__m128 const queryCenterX = _mm_set1_ps(query.Center.x);
+			__m128 const queryCenterY = _mm_set1_ps(query.Center.y);
+			__m128 const queryAxisX = _mm_set1_ps(query.AxisX.x);
+			__m128 const queryAxisY = _mm_set1_ps(query.AxisX.y);
+			__m128 const queryHalfExtentX = _mm_set1_ps(query.HalfExtents.x);
+			__m128 const queryHalfExtentY = _mm_set1_ps(query.HalfExtents.y);
+			__m128 const displacementX = _mm_set1_ps(query.Displacement.x);
+			__m128 const displacementY = _mm_set1_ps(query.Displacement.y);
+			__m128 const queryInverseSpeedX = _mm_set1_ps(query.InverseSpeed.x);
+			__m128 const queryInverseSpeedY = _mm_set1_ps(query.InverseSpeed.y);
+			__m128 const maxFractions = _mm_set1_ps(query.MaxFraction);
+			__m128 const signMask = _mm_set1_ps(-0.0f);
+
+			std::uint32_t count = 0;
+			std::uint32_t i = begin;
+			for (; i + 4 <= end; i += 4)
+			{
+				__m128 const offsetX = _mm_sub_ps(_mm_loadu_ps(&streams.CenterX[i]), queryCenterX);
+				__m128 const offsetY = _mm_sub_ps(_mm_loadu_ps(&streams.CenterY[i]), queryCenterY);
+				__m128 const axisX = _mm_loadu_ps(&streams.AxisX[i]);
+				__m128 const axisY = _mm_loadu_ps(&streams.AxisY[i]);
+				__m128 const halfExtentX = _mm_loadu_ps(&streams.HalfExtentX[i]);
+				__m128 const halfExtentY = _mm_loadu_ps(&streams.HalfExtentY[i]);
+
+				__m128 const cosine = _mm_andnot_ps(signMask, _mm_add_ps(_mm_mul_ps(queryAxisX, axisX), _mm_mul_ps(queryAxisY, axisY)));
+				__m128 const sine = _mm_andnot_ps(signMask, _mm_sub_ps(_mm_mul_ps(queryAxisY, axisX), _mm_mul_ps(queryAxisX, axisY)));
+
+				__m128 tMin = _mm_setzero_ps();
+				__m128 tMax = maxFractions;
+
+				clipSeparatingAxisSSE(_mm_add_ps(_mm_mul_ps(offsetX, queryAxisX), _mm_mul_ps(offsetY, queryAxisY)),
+									  _mm_add_ps(queryHalfExtentX, _mm_add_ps(_mm_mul_ps(halfExtentX, cosine), _mm_mul_ps(halfExtentY, sine))),
+									  queryInverseSpeedX, tMin, tMax);
+				clipSeparatingAxisSSE(_mm_sub_ps(_mm_mul_ps(offsetY, queryAxisX), _mm_mul_ps(offsetX, queryAxisY)),
+									  _mm_add_ps(queryHalfExtentY, _mm_add_ps(_mm_mul_ps(halfExtentX, sine), _mm_mul_ps(halfExtentY, cosine))),
+									  queryInverseSpeedY, tMin, tMax);
+
+				clipSeparatingAxisSSE(_mm_add_ps(_mm_mul_ps(offsetX, axisX), _mm_mul_ps(offsetY, axisY)),
+									  _mm_add_ps(halfExtentX, _mm_add_ps(_mm_mul_ps(queryHalfExtentX, cosine), _mm_mul_ps(queryHalfExtentY, sine))),
+									  safeInverseSSE(_mm_add_ps(_mm_mul_ps(displacementX, axisX), _mm_mul_ps(displacementY, axisY))), tMin, tMax);
+				clipSeparatingAxisSSE(_mm_sub_ps(_mm_mul_ps(offsetY, axisX), _mm_mul_ps(offsetX, axisY)),
+									  _mm_add_ps(halfExtentY, _mm_add_ps(_mm_mul_ps(queryHalfExtentX, sine), _mm_mul_ps(queryHalfExtentY, cosine))),
+									  safeInverseSSE(_mm_sub_ps(_mm_mul_ps(displacementY, axisX), _mm_mul_ps(displacementX, axisY))), tMin, tMax);
+
+				std::uint32_t const laneMask = (std::uint32_t) _mm_movemask_ps(_mm_cmple_ps(tMin, tMax));
+				if (laneMask != 0)
+				{
+					count = appendLanes(laneMask, i, outIndices, count);
+				}
+			}
+
+			return sweptOrientedBoxScalar(streams, i, end, query, outIndices, count);
+		}
+
+		std::uint32_t rayPacketBoxSSE(RayPacket const& packet, glm::vec2 boxMin, glm::vec2 boxMax)
+		{
+			__m128 const minX = _mm_set1_ps(boxMin.x - packet.Start.x);
+			__m128 const minY = _mm_set1_ps(boxMin.y - packet.Start.y);
+			__m128 const maxX = _mm_set1_ps(boxMax.x - packet.Start.x);
+			__m128 const maxY = _mm_set1_ps(boxMax.y - packet.Start.y);
+			__m128 const zero = _mm_setzero_ps();
+
+			// Two halves of 4 rays each.
+			std::uint32_t hitMask = 0;
+			for (std::uint32_t firstRay = 0; firstRay < packet.RayCount; firstRay += 4)
+			{
+				__m128 const inverseDisplacementX = _mm_load_ps(&packet.InverseDisplacementX[firstRay]);
+				__m128 const inverseDisplacementY = _mm_load_ps(&packet.InverseDisplacementY[firstRay]);
+
+				__m128 const tx1 = _mm_mul_ps(minX, inverseDisplacementX);
+				__m128 const tx2 = _mm_mul_ps(maxX, inverseDisplacementX);
+				__m128 const ty1 = _mm_mul_ps(minY, inverseDisplacementY);
+				__m128 const ty2 = _mm_mul_ps(maxY, inverseDisplacementY);
+
+				__m128 const tMin = _mm_max_ps(_mm_max_ps(_mm_min_ps(tx1, tx2), _mm_min_ps(ty1, ty2)), zero);
+				__m128 const tMax = _mm_min_ps(_mm_min_ps(_mm_max_ps(tx1, tx2), _mm_max_ps(ty1, ty2)), _mm_load_ps(&packet.MaxFraction[firstRay]));
+
+				hitMask |= (std::uint32_t) _mm_movemask_ps(_mm_cmple_ps(tMin, tMax)) << firstRay;
+			}
+
+			return hitMask & ((1u << packet.RayCount) - 1);
+		}
+
+		// AVX2 kernels, only called after the runtime check in GetBestInstructionSet().
+
+		DYE_TARGET_AVX2
+		std::uint32_t overlapBoxAVX2(AABBStreams const& streams, std::uint32_t begin, std::uint32_t end,
+									 glm::vec2 min, glm::vec2 max, std::uint32_t* outIndices)
+		{
+			__m256 const queryMinX = _mm256_set1_ps(min.x);
+			__m256 const queryMinY = _mm256_set1_ps(min.y);
+			__m256 const queryMaxX = _mm256_set1_ps(max.x);
+			__m256 const queryMaxY = _mm256_set1_ps(max.y);
+
+			std::uint32_t count = 0;
+			std::uint32_t i = begin;
+			for (; i + 8 <= end; i += 8)
+			{
+				__m256 overlap = _mm256_cmp_ps(_mm256_loadu_ps(&streams.MinX[i]), queryMaxX, _CMP_LE_OQ);
+				overlap = _mm256_and_ps(overlap, _mm256_cmp_ps(_mm256_loadu_ps(&streams.MaxX[i]), queryMinX, _CMP_GE_OQ));
+				overlap = _mm256_and_ps(overlap, _mm256_cmp_ps(_mm256_loadu_ps(&streams.MinY[i]), queryMaxY, _CMP_LE_OQ));
+				overlap = _mm256_and_ps(overlap, _mm256_cmp_ps(_mm256_loadu_ps(&streams.MaxY[i]), queryMinY, _CMP_GE_OQ));
+
+				std::uint32_t const laneMask = (std::uint32_t) _mm256_movemask_ps(overlap);
+				if (laneMask != 0)
+				{
+					count = appendLanes(laneMask, i, outIndices, count);
+				}
+			}
+
+			return overlapBoxScalar(streams, i, end, min, max, outIndices, count);
+		}
+
+		DYE_TARGET_AVX2
+		std::uint32_t overlapCircleAVX2(AABBStreams const& streams, std::uint32_t begin, std::uint32_t end,
+										glm::vec2 center, float radiusSquared, std::uint32_t* outIndices)
+		{
+			__m256 const centerX = _mm256_set1_ps(center.x);
+			__m256 const centerY = _mm256_set1_ps(center.y);
+			__m256 const maxDistanceSquared = _mm256_set1_ps(radiusSquared);
+			__m256 const zero = _mm256_setzero_ps();
+
+			std::uint32_t count = 0;
+			std::uint32_t i = begin;
+			for (; i + 8 <= end; i += 8)
+			{
+				__m256 const dx = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(_mm256_loadu_ps(&streams.MinX[i]), centerX),
+															  _mm256_sub_ps(centerX, _mm256_loadu_ps(&streams.MaxX[i]))), zero);
+				__m256 const dy = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(_mm256_loadu_ps(&streams.MinY[i]), centerY),
+															  _mm256_sub_ps(centerY, _mm256_loadu_ps(&streams.MaxY[i]))), zero);
+
+				// No FMA here, the scalar fallback rounds the multiply and the add separately.
+				__m256 const distanceSquared = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+
+				__m256 const isHit = _mm256_cmp_ps(distanceSquared, maxDistanceSquared, _CMP_LE_OQ);
+				std::uint32_t const laneMask = (std::uint32_t) _mm256_movemask_ps(isHit);
+				if (laneMask != 0)
+				{
+					count = appendLanes(laneMask, i, outIndices, count);
+				}
+			}
+
+			return overlapCircleScalar(streams, i, end, center, radiusSquared, outIndices, count);
+		}
+
+		DYE_TARGET_AVX2
+		std::uint32_t sweptBoxAVX2(AABBStreams const& streams, std::uint32_t begin, std::uint32_t end,
+								   BroadPhaseSegment const& segment, glm::vec2 extents, float maxFraction, std::uint32_t* outIndices)
+		{
+			__m256 const startX = _mm256_set1_ps(segment.Start.x);
+			__m256 const startY = _mm256_set1_ps(segment.Start.y);
+			__m256 const inverseDisplacementX = _mm256_set1_ps(segment.InverseDisplacement.x);
+			__m256 const inverseDisplacementY = _mm256_set1_ps(segment.InverseDisplacement.y);
+			__m256 const extentsX = _mm256_set1_ps(extents.x);
+			__m256 const extentsY = _mm256_set1_ps(extents.y);
+			__m256 const zero = _mm256_setzero_ps();
+			__m256 const maxFractions = _mm256_set1_ps(maxFraction);
+
+			std::uint32_t count = 0;
+			std::uint32_t i = begin;
+			for (; i + 8 <= end; i += 8)
+			{
+				__m256 const minX = _mm256_sub_ps(_mm256_loadu_ps(&streams.MinX[i]), extentsX);
+				__m256 const maxX = _mm256_add_ps(_mm256_loadu_ps(&streams.MaxX[i]), extentsX);
+				__m256 const minY = _mm256_sub_ps(_mm256_loadu_ps(&streams.MinY[i]), extentsY);
+				__m256 const maxY = _mm256_add_ps(_mm256_loadu_ps(&streams.MaxY[i]), extentsY);
+
+				__m256 tMin = zero;
+				__m256 tMax = maxFractions;
+				__m256 isInsideSlabs = _mm256_cmp_ps(zero, zero, _CMP_EQ_OQ);
+
+				if (segment.IsParallelX)
+				{
+					isInsideSlabs = _mm256_and_ps(isInsideSlabs, _mm256_and_ps(_mm256_cmp_ps(startX, minX, _CMP_GE_OQ), _mm256_cmp_ps(startX, maxX, _CMP_LE_OQ)));
+				}
+				else
+				{
+					__m256 const t1 = _mm256_mul_ps(_mm256_sub_ps(minX, startX), inverseDisplacementX);
+					__m256 const t2 = _mm256_mul_ps(_mm256_sub_ps(maxX, startX), inverseDisplacementX);
+					tMin = _mm256_max_ps(tMin, _mm256_min_ps(t1, t2));
+					tMax = _mm256_min_ps(tMax, _mm256_max_ps(t1, t2));
+				}
+
+				if (segment.IsParallelY)
+				{
+					isInsideSlabs = _mm256_and_ps(isInsideSlabs, _mm256_and_ps(_mm256_cmp_ps(startY, minY, _CMP_GE_OQ), _mm256_cmp_ps(startY, maxY, _CMP_LE_OQ)));
+				}
+				else
+				{
+					__m256 const t1 = _mm256_mul_ps(_mm256_sub_ps(minY, startY), inverseDisplacementY);
+					__m256 const t2 = _mm256_mul_ps(_mm256_sub_ps(maxY, startY), inverseDisplacementY);
+					tMin = _mm256_max_ps(tMin, _mm256_min_ps(t1, t2));
+					tMax = _mm256_min_ps(tMax, _mm256_max_ps(t1, t2));
+				}
+
+				__m256 const isHit = _mm256_and_ps(isInsideSlabs, _mm256_cmp_ps(tMin, tMax, _CMP_LE_OQ));
+				std::uint32_t const laneMask = (std::uint32_t) _mm256_movemask_ps(isHit);
+				if (laneMask != 0)
+				{
+					count = appendLanes(laneMask, i, outIndices, count);
+				}
+			}
+
+			return sweptBoxScalar(streams, i, end, segment, extents, maxFraction, outIndices, count);
+		}
+
+		DYE_TARGET_AVX2
+		void clipSeparatingAxisAVX2(__m256 distance, __m256 radius, __m256 inverseSpeed, __m256& tMin, __m256& tMax)
+		{
+			__m256 const paddedRadius = _mm256_add_ps(_mm256_mul_ps(radius, _mm256_set1_ps(1.0f + SweepTolerance)), _mm256_set1_ps(SweepTolerance));
+			__m256 const t1 = _mm256_mul_ps(_mm256_sub_ps(distance, paddedRadius), inverseSpeed);
+			__m256 const t2 = _mm256_mul_ps(_mm256_add_ps(distance, paddedRadius), inverseSpeed);
+			tMin = _mm256_max_ps(tMin, _mm256_min_ps(t1, t2));
+			tMax = _mm256_min_ps(tMax, _mm256_max_ps(t1, t2));
+		}
+
+		DYE_TARGET_AVX2
+		__m256 safeInverseAVX2(__m256 value)
+		{
+			__m256 const isZero = _mm256_cmp_ps(value, _mm256_setzero_ps(), _CMP_EQ_OQ);
+			return _mm256_blendv_ps(_mm256_div_ps(_mm256_set1_ps(1.0f), value), _mm256_set1_ps(1e30f), isZero);
+		}
+
+		DYE_TARGET_AVX2
+		std::uint32_t sweptOrientedBoxAVX2(OrientedBoxStreams const& streams, std::uint32_t begin, std::uint32_t end,
+										   SweptOrientedBoxQuery const& query, std::uint32_t* outIndices)
+		{
+			__m256 const queryCenterX = _mm256_set1_ps(query.Center.x);
+			__m256 const queryCenterY = _mm256_set1_ps(query.Center.y);
+			__m256 const queryAxisX = _mm256_set1_ps(query.AxisX.x);
+			__m256 const queryAxisY = _mm256_set1_ps(query.AxisX.y);
+			__m256 const queryHalfExtentX = _mm256_set1_ps(query.HalfExtents.x);
+			__m256 const queryHalfExtentY = _mm256_set1_ps(query.HalfExtents.y);
+			__m256 const displacementX = _mm256_set1_ps(query.Displacement.x);
+			__m256 const displacementY = _mm256_set1_ps(query.Displacement.y);
+			__m256 const queryInverseSpeedX = _mm256_set1_ps(query.InverseSpeed.x);
+			__m256 const queryInverseSpeedY = _mm256_set1_ps(query.InverseSpeed.y);
+			__m256 const maxFractions = _mm256_set1_ps(query.MaxFraction);
+			__m256 const signMask = _mm256_set1_ps(-0.0f);
+
+			std::uint32_t count = 0;
+			std::uint32_t i = begin;
+			for (; i + 8 <= end; i += 8)
+			{
+				__m256 const offsetX = _mm256_sub_ps(_mm256_loadu_ps(&streams.CenterX[i]), queryCenterX);
+				__m256 const offsetY = _mm256_sub_ps(_mm256_loadu_ps(&streams.CenterY[i]), queryCenterY);
+				__m256 const axisX = _mm256_loadu_ps(&streams.AxisX[i]);
+				__m256 const axisY = _mm256_loadu_ps(&streams.AxisY[i]);
+				__m256 const halfExtentX = _mm256_loadu_ps(&streams.HalfExtentX[i]);
+				__m256 const halfExtentY = _mm256_loadu_ps(&streams.HalfExtentY[i]);
+
+				__m256 const cosine = _mm256_andnot_ps(signMask, _mm256_add_ps(_mm256_mul_ps(queryAxisX, axisX), _mm256_mul_ps(queryAxisY, axisY)));
+				__m256 const sine = _mm256_andnot_ps(signMask, _mm256_sub_ps(_mm256_mul_ps(queryAxisY, axisX), _mm256_mul_ps(queryAxisX, axisY)));
+
+				__m256 tMin = _mm256_setzero_ps();
+				__m256 tMax = maxFractions;
+
+				clipSeparatingAxisAVX2(_mm256_add_ps(_mm256_mul_ps(offsetX, queryAxisX), _mm256_mul_ps(offsetY, queryAxisY)),
+									   _mm256_add_ps(queryHalfExtentX, _mm256_add_ps(_mm256_mul_ps(halfExtentX, cosine), _mm256_mul_ps(halfExtentY, sine))),
+									   queryInverseSpeedX, tMin, tMax);
+				clipSeparatingAxisAVX2(_mm256_sub_ps(_mm256_mul_ps(offsetY, queryAxisX), _mm256_mul_ps(offsetX, queryAxisY)),
+									   _mm256_add_ps(queryHalfExtentY, _mm256_add_ps(_mm256_mul_ps(halfExtentX, sine), _mm256_mul_ps(halfExtentY, cosine))),
+									   queryInverseSpeedY, tMin, tMax);
+
+				clipSeparatingAxisAVX2(_mm256_add_ps(_mm256_mul_ps(offsetX, axisX), _mm256_mul_ps(offsetY, axisY)),
+									   _mm256_add_ps(halfExtentX, _mm256_add_ps(_mm256_mul_ps(queryHalfExtentX, cosine), _mm256_mul_ps(queryHalfExtentY, sine))),
+									   safeInverseAVX2(_mm256_add_ps(_mm256_mul_ps(displacementX, axisX), _mm256_mul_ps(displacementY, axisY))), tMin, tMax);
+				clipSeparatingAxisAVX2(_mm256_sub_ps(_mm256_mul_ps(offsetY, axisX), _mm256_mul_ps(offsetX, axisY)),
+									   _mm256_add_ps(halfExtentY, _mm256_add_ps(_mm256_mul_ps(queryHalfExtentX, sine), _mm256_mul_ps(queryHalfExtentY, cosine))),
+									   safeInverseAVX2(_mm256_sub_ps(_mm256_mul_ps(displacementY, axisX), _mm256_mul_ps(displacementX, axisY))), tMin, tMax);
+
+				std::uint32_t const laneMask = (std::uint32_t) _mm256_movemask_ps(_mm256_cmp_ps(tMin, tMax, _CMP_LE_OQ));
+				if (laneMask != 0)
+				{
+					count = appendLanes(laneMask, i, outIndices, count);
+				}
+			}
+
+			return sweptOrientedBoxScalar(streams, i, end, query, outIndices, count);
+		}
+
+		DYE_TARGET_AVX2
+		std::uint32_t rayPacketBoxAVX2(RayPacket const& packet, glm::vec2 boxMin, glm::vec2 boxMax)
+		{
+			__m256 const inverseDisplacementX = _mm256_load_ps(packet.InverseDisplacementX);
+			__m256 const inverseDisplacementY = _mm256_load_ps(packet.InverseDisplacementY);
+
+			__m256 const tx1 = _mm256_mul_ps(_mm256_set1_ps(boxMin.x - packet.Start.x), inverseDisplacementX);
+			__m256 const tx2 = _mm256_mul_ps(_mm256_set1_ps(boxMax.x - packet.Start.x), inverseDisplacementX);
+			__m256 const ty1 = _mm256_mul_ps(_mm256_set1_ps(boxMin.y - packet.Start.y), inverseDisplacementY);
+			__m256 const ty2 = _mm256_mul_ps(_mm256_set1_ps(boxMax.y - packet.Start.y), inverseDisplacementY);
+
+			__m256 const tMin = _mm256_max_ps(_mm256_max_ps(_mm256_min_ps(tx1, tx2), _mm256_min_ps(ty1, ty2)), _mm256_setzero_ps());
+			__m256 const tMax = _mm256_min_ps(_mm256_min_ps(_mm256_max_ps(tx1, tx2), _mm256_max_ps(ty1, ty2)), _mm256_load_ps(packet.MaxFraction));
+
+			std::uint32_t const hitMask = (std::uint32_t) _mm256_movemask_ps(_mm256_cmp_ps(tMin, tMax, _CMP_LE_OQ));
+			return hitMask & ((1u << packet.RayCount) - 1);
+		}
+#endif
+	}
+
+	InstructionSet GetBestInstructionSet()
+	{
+		static InstructionSet const bestInstructionSet = []()
+		{
+#if defined(DYE_COLLISION_KERNELS_X86)
+			return isAVX2SupportedByCPU()? InstructionSet::AVX2 : InstructionSet::SSE;
+#else
+			return InstructionSet::Scalar;
+#endif
+		}();
+
+		return bestInstructionSet;
+	}
+
+	bool IsInstructionSetSupported(InstructionSet instructionSet)
+	{
+		return (int) instructionSet <= (int) GetBestInstructionSet();
+	}
+
+	char const* GetInstructionSetName(InstructionSet instructionSet)
+	{
+		switch (instructionSet)
+		{
+			case InstructionSet::Scalar:
+				return "Scalar";
+			case InstructionSet::SSE:
+				return "SSE";
+			case InstructionSet::AVX2:
+				return "AVX2";
+		}
+
+		return "Unknown";
+	}
+
+	std::uint32_t OverlapBox(AABBStreams const& streams, std::uint32_t begin, std::uint32_t end,
+							 glm::vec2 min, glm::vec2 max, std::uint32_t* outIndices, InstructionSet instructionSet)
+	{
+		switch (instructionSet)
+		{
+#if defined(DYE_COLLISION_KERNELS_X86)
+			case InstructionSet::AVX2:
+				return overlapBoxAVX2(streams, begin, end, min, max, outIndices);
+			case InstructionSet::SSE:
+				return overlapBoxSSE(streams, begin, end, min, max, outIndices);
+#endif
+			default:
+				return overlapBoxScalar(streams, begin, end, min, max, outIndices, 0);
+		}
+	}
+
+	std::uint32_t OverlapCircle(AABBStreams const& streams, std::uint32_t begin, std::uint32_t end,
+								glm::vec2 center, float radius, std::uint32_t* outIndices, InstructionSet instructionSet)
+	{
+		float const radiusSquared = paddedRadiusSquared(radius);
+
+		switch (instructionSet)
+		{
+#if defined(DYE_COLLISION_KERNELS_X86)
+			case InstructionSet::AVX2:
+				return overlapCircleAVX2(streams, begin, end, center, radiusSquared, outIndices);
+			case InstructionSet::SSE:
+				return overlapCircleSSE(streams, begin, end, center, radiusSquared, outIndices);
+#endif
+			default:
+				return overlapCircleScalar(streams, begin, end, center, radiusSquared, outIndices, 0);
+		}
+	}
+
+	std::uint32_t SweptBox(AABBStreams const& streams, std::uint32_t begin, std::uint32_t end,
+						   BroadPhaseSegment const& segment, glm::vec2 halfExtents, float maxFraction, std::uint32_t* outIndices,
+						   InstructionSet instructionSet)
+	{
+		glm::vec2 const extents = paddedSweepExtents(halfExtents);
+
+		switch (instructionSet)
+		{
+#if defined(DYE_COLLISION_KERNELS_X86)
+			case InstructionSet::AVX2:
+				return sweptBoxAVX2(streams, begin, end, segment, extents, maxFraction, outIndices);
+			case InstructionSet::SSE:
+				return sweptBoxSSE(streams, begin, end, segment, extents, maxFraction, outIndices);
+#endif
+			default:
+				return sweptBoxScalar(streams, begin, end, segment, extents, maxFraction, outIndices, 0);
+		}
+	}
+
+	std::uint32_t SweptOrientedBox(OrientedBoxStreams const& streams, std::uint32_t begin, std::uint32_t end,
+								   OrientedBox2D const& box, glm::vec2 displacement, float maxFraction, std::uint32_t* outIndices,
+								   InstructionSet instructionSet)
+	{
+		SweptOrientedBoxQuery const query
+		{
+			.Center = box.Center,
+			.HalfExtents = box.HalfExtents,
+			.AxisX = box.AxisX,
+			.Displacement = displacement,
+			.InverseSpeed = {safeInverse(glm::dot(displacement, box.AxisX)), safeInverse(glm::dot(displacement, box.GetAxisY()))},
+			.MaxFraction = maxFraction
+		};
+
+		switch (instructionSet)
+		{
+#if defined(DYE_COLLISION_KERNELS_X86)
+			case InstructionSet::AVX2:
+				return sweptOrientedBoxAVX2(streams, begin, end, query, outIndices);
+			case InstructionSet::SSE:
+				return sweptOrientedBoxSSE(streams, begin, end, query, outIndices);
+#endif
+			default:
+				return sweptOrientedBoxScalar(streams, begin, end, query, outIndices, 0);
+		}
+	}
+
+	std::uint32_t RayPacketBox(RayPacket const& packet, glm::vec2 boxMin, glm::vec2 boxMax, InstructionSet instructionSet)
+	{
+		glm::vec2 const padding = paddedSweepExtents({0, 0});
+		boxMin -= padding;
+		boxMax += padding;
+
+		switch (instructionSet)
+		{
+#if defined(DYE_COLLISION_KERNELS_X86)
+			case InstructionSet::AVX2:
+				return rayPacketBoxAVX2(packet, boxMin, boxMax);
+			case InstructionSet::SSE:
+				return rayPacketBoxSSE(packet, boxMin, boxMax);
+#endif
+			default:
+				return rayPacketBoxScalar(packet, boxMin, boxMax);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,201 @@
+#pragma once
+
+#include "src/BroadPhase.h"
+#include "src/OrientedBox2D.h"
+
+#include "Math/AABB.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace DYE
+{
+	/// The 2D bounds of a set of boxes stored as a structure of arrays,
+	/// so the collision kernels can load the same component of several boxes in one instruction.
+	struct AABBStreams
+	{
+		std::vector<float> MinX;
+		std::vector<float> MinY;
+		std::vector<float> MaxX;
+		std::vector<float> MaxY;
+
+		std::uint32_t Size() const { return (std::uint32_t) MinX.size(); }
+
+		void PushBack(Math::AABB const& aabb)
+		{
+			MinX.push_back(aabb.Min.x);
+			MinY.push_back(aabb.Min.y);
+			MaxX.push_back(aabb.Max.x);
+			MaxY.push_back(aabb.Max.y);
+		}
+
+		void Set(std::uint32_t index, Math::AABB const& aabb)
+		{
+			MinX[index] = aabb.Min.x;
+			MinY[index] = aabb.Min.y;
+			MaxX[index] = aabb.Max.x;
+			MaxY[index] = aabb.Max.y;
+		}
+
+		/// Move the last box into the given index and shrink the streams by one, mirrors a swap and pop on the dense colliders.
+		void SwapAndPop(std::uint32_t index)
+		{
+			MinX[index] = MinX.back();
+			MinY[index] = MinY.back();
+			MaxX[index] = MaxX.back();
+			MaxY[index] = MaxY.back();
+
+			MinX.pop_back();
+			MinY.pop_back();
+			MaxX.pop_back();
+			MaxY.pop_back();
+		}
+
+		void Clear()
+		{
+			MinX.clear();
+			MinY.clear();
+			MaxX.clear();
+			MaxY.clear();
+		}
+	};
+
+	/// The centers, half extents and local x axes of a set of oriented boxes, in the same order as the AABBStreams of their bounds.
+	/// An axis-aligned box is stored with the axis {1, 0}.
+	struct OrientedBoxStreams
+	{
+		std::vector<float> CenterX;
+		std::vector<float> CenterY;
+		std::vector<float> HalfExtentX;
+		std::vector<float> HalfExtentY;
+		std::vector<float> AxisX;
+		std::vector<float> AxisY;
+
+		std::uint32_t Size() const { return (std::uint32_t) CenterX.size(); }
+
+		void PushBack(OrientedBox2D const& box)
+		{
+			CenterX.push_back(box.Center.x);
+			CenterY.push_back(box.Center.y);
+			HalfExtentX.push_back(box.HalfExtents.x);
+			HalfExtentY.push_back(box.HalfExtents.y);
+			AxisX.push_back(box.AxisX.x);
+			AxisY.push_back(box.AxisX.y);
+		}
+
+		void Set(std::uint32_t index, OrientedBox2D const& box)
+		{
+			CenterX[index] = box.Center.x;
+			CenterY[index] = box.Center.y;
+			HalfExtentX[index] = box.HalfExtents.x;
+			HalfExtentY[index] = box.HalfExtents.y;
+			AxisX[index] = box.AxisX.x;
+			AxisY[index] = box.AxisX.y;
+		}
+
+		void SwapAndPop(std::uint32_t index)
+		{
+			CenterX[index] = CenterX.back();
+			CenterY[index] = CenterY.back();
+			HalfExtentX[index] = HalfExtentX.back();
+			HalfExtentY[index] = HalfExtentY.back();
+			AxisX[index] = AxisX.back();
+			AxisY[index] = AxisY.back();
+
+			CenterX.pop_back();
+			CenterY.pop_back();
+			HalfExtentX.pop_back();
+			HalfExtentY.pop_back();
+			AxisX.pop_back();
+			AxisY.pop_back();
+		}
+
+		void Clear()
+		{
+			CenterX.clear();
+			CenterY.clear();
+			HalfExtentX.clear();
+			HalfExtentY.clear();
+			AxisX.clear();
+			AxisY.clear();
+		}
+	};
+
+	/// Up to RayPacket::MaxRayCount rays sharing a start point, stored as a structure of arrays so one box can be tested against all of them at once.
+	/// Each ray goes from Start to Start + Displacement, and is limited to [0, MaxFraction] of its displacement.
+	struct RayPacket
+	{
+		constexpr static std::uint32_t MaxRayCount = 8;
+
+		glm::vec2 Start {0, 0};
+		std::uint32_t RayCount = 0;
+
+		alignas(32) float InverseDisplacementX[MaxRayCount] {};
+		alignas(32) float InverseDisplacementY[MaxRayCount] {};
+		alignas(32) float MaxFraction[MaxRayCount] {};
+
+		/// Add a ray to the packet, the packet must not be full.
+		/// An axis with no displacement gets a huge inverse instead of infinity, so the slab test never produces a NaN.
+		void AddRay(glm::vec2 displacement)
+		{
+			constexpr float hugeInverse = 1e30f;
+			InverseDisplacementX[RayCount] = displacement.x == 0.0f? hugeInverse : 1.0f / displacement.x;
+			InverseDisplacementY[RayCount] = displacement.y == 0.0f? hugeInverse : 1.0f / displacement.y;
+			MaxFraction[RayCount] = 1.0f;
+			RayCount++;
+		}
+	};
+
+	/// Brute force filters over AABBStreams, used by the linear broad-phase.
+	/// The kernels are conservative: a box that passes the exact test in Math::PrimitiveTest always passes the kernel,
+	/// the caller confirms each candidate with the scalar test so the final hit/no-hit result is the same on every instruction set.
+	namespace CollisionKernels
+	{
+		enum class InstructionSet
+		{
+			Scalar,
+			SSE,	// 4 boxes per instruction.
+			AVX2	// 8 boxes per instruction.
+		};
+
+		/// The max number of boxes tested per kernel call, callers can keep the output indices on the stack.
+		constexpr std::uint32_t ChunkSize = 256;
+
+		/// The widest instruction set supported by the running CPU, detected once.
+		InstructionSet GetBestInstructionSet();
+		bool IsInstructionSetSupported(InstructionSet instructionSet);
+		char const* GetInstructionSetName(InstructionSet instructionSet);
+
+		// Every kernel tests the boxes in [begin, end), writes the indices of the candidates to outIndices
+		// and returns the number of candidates. end - begin must not exceed ChunkSize.
+
+		/// Boxes overlapping with the given box, touching boxes included.
+		std::uint32_t OverlapBox(AABBStreams const& streams, std::uint32_t begin, std::uint32_t end,
+								 glm::vec2 min, glm::vec2 max, std::uint32_t* outIndices,
+								 InstructionSet instructionSet = GetBestInstructionSet());
+
+		/// Boxes within the radius of the given center.
+		std::uint32_t OverlapCircle(AABBStreams const& streams, std::uint32_t begin, std::uint32_t end,
+									glm::vec2 center, float radius, std::uint32_t* outIndices,
+									InstructionSet instructionSet = GetBestInstructionSet());
+
+		/// Boxes touched by a box of the given half extents swept along [0, maxFraction] of the segment.
+		/// A zero half extents is a ray, a circle cast passes {radius, radius}.
+		std::uint32_t SweptBox(AABBStreams const& streams, std::uint32_t begin, std::uint32_t end,
+							   BroadPhaseSegment const& segment, glm::vec2 halfExtents, float maxFraction, std::uint32_t* outIndices,
+							   InstructionSet instructionSet = GetBestInstructionSet());
+
+		/// Boxes touched by the oriented box moved along [0, maxFraction] of the displacement,
+		/// the separating axis test of MovingOrientedBoxIntersect on the 4 axes of each pair, one pair per lane.
+		std::uint32_t SweptOrientedBox(OrientedBoxStreams const& streams, std::uint32_t begin, std::uint32_t end,
+									   OrientedBox2D const& box, glm::vec2 displacement, float maxFraction, std::uint32_t* outIndices,
+									   InstructionSet instructionSet = GetBestInstructionSet());
+
+		/// Slab test of every ray of the packet against one box, the multi-ray version of Math::RayAABBIntersect2D.
+		/// \return a mask with bit i set if ray i might hit the box within its max fraction.
+		std::uint32_t RayPacketBox(RayPacket const& packet, glm::vec2 boxMin, glm::vec2 boxMax,
+								   InstructionSet instructionSet = GetBestInstructionSet());
+	}
+}
\ No newline at end of file
@@ -16,6 +16,7 @@ namespace DYE::MiniGame
 
 	struct CircleCollider
 	{
+		std::optional<ColliderID> ID;
 		float Radius = 0.5f;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,476 @@
+#include "DynamicAABBTree.h"
+
+#include <algorithm>
+
+namespace DYE
+{
+	DynamicAABBTree::DynamicAABBTree(float fatMargin) : m_FatMargin(fatMargin)
+	{
+	}
+
+	std::int32_t DynamicAABBTree::CreateProxy(Math::AABB const& aabb, std::int32_t userData, std::uint32_t categoryBits)
+	{
+		std::int32_t const proxyId = allocateNode();
+
+		Node& node = m_Nodes[proxyId];
+		node.Min = glm::vec2 {aabb.Min.x, aabb.Min.y} - glm::vec2 {m_FatMargin, m_FatMargin};
+		node.Max = glm::vec2 {aabb.Max.x, aabb.Max.y} + glm::vec2 {m_FatMargin, m_FatMargin};
+		node.UserData = userData;
+		node.CategoryBits = categoryBits;
+		node.Height = 0;
+
+		insertLeaf(proxyId);
+		m_ProxyCount++;
+
+		return proxyId;
+	}
+
+	void DynamicAABBTree::DestroyProxy(std::int32_t proxyId)
+	{
+		if (proxyId < 0 || (std::size_t) proxyId >= m_Nodes.size() || !m_Nodes[proxyId].IsLeaf() || m_Nodes[proxyId].Height != 0)
+		{
+			return;
+		}
+
+		removeLeaf(proxyId);
+		freeNode(proxyId);
+		m_ProxyCount--;
+	}
+
+	bool DynamicAABBTree::MoveProxy(std::int32_t proxyId, Math::AABB const& aabb, glm::vec2 predictedDisplacement)
+	{
+		// The leaf is out of the tree while it is reinserted, its bounds can be changed first.
+		if (!fattenIfEscaped(proxyId, aabb, predictedDisplacement))
+		{
+			return false;
+		}
+
+		removeLeaf(proxyId);
+		insertLeaf(proxyId);
+		return true;
+	}
+
+	std::uint32_t DynamicAABBTree::MoveProxies(std::span<std::int32_t const> proxyIds, std::span<Math::AABB const> aabbs,
+											   std::span<glm::vec2 const> predictedDisplacements)
+	{
+		m_EscapedLeaves.clear();
+		for (std::size_t i = 0; i < proxyIds.size(); i++)
+		{
+			glm::vec2 const predictedDisplacement = predictedDisplacements.empty()? glm::vec2 {0, 0} : predictedDisplacements[i];
+			if (fattenIfEscaped(proxyIds[i], aabbs[i], predictedDisplacement))
+			{
+				m_EscapedLeaves.push_back(proxyIds[i]);
+			}
+		}
+
+		if (m_EscapedLeaves.empty())
+		{
+			return 0;
+		}
+
+		if ((std::int64_t) m_EscapedLeaves.size() * BatchRefitRatio <= m_ProxyCount)
+		{
+			// The leaves waiting for their turn are already fattened, the ancestors refitted meanwhile only become a bit larger.
+			for (std::int32_t const leaf : m_EscapedLeaves)
+			{
+				removeLeaf(leaf);
+				insertLeaf(leaf);
+			}
+		}
+		else
+		{
+			m_RefittedLeafCount += (std::int64_t) m_EscapedLeaves.size();
+			if (m_RefittedLeafCount >= m_ProxyCount)
+			{
+				rebuild();
+			}
+			else
+			{
+				refitAll();
+			}
+		}
+
+		return (std::uint32_t) m_EscapedLeaves.size();
+	}
+
+	bool DynamicAABBTree::fattenIfEscaped(std::int32_t proxyId, Math::AABB const& aabb, glm::vec2 predictedDisplacement)
+	{
+		Node& node = m_Nodes[proxyId];
+
+		// Stretch the fattened AABB toward where the proxy is heading only.
+		glm::vec2 const fatMin = glm::vec2 {aabb.Min.x, aabb.Min.y} - glm::vec2 {m_FatMargin, m_FatMargin} + glm::min(predictedDisplacement, glm::vec2 {0, 0});
+		glm::vec2 const fatMax = glm::vec2 {aabb.Max.x, aabb.Max.y} + glm::vec2 {m_FatMargin, m_FatMargin} + glm::max(predictedDisplacement, glm::vec2 {0, 0});
+
+		bool const isContained = node.Min.x <= aabb.Min.x && node.Min.y <= aabb.Min.y &&
+								 aabb.Max.x <= node.Max.x && aabb.Max.y <= node.Max.y;
+		if (isContained)
+		{
+			glm::vec2 const shrinkMargin {ShrinkMarginCount * m_FatMargin, ShrinkMarginCount * m_FatMargin};
+			glm::vec2 const largestMin = fatMin - shrinkMargin;
+			glm::vec2 const largestMax = fatMax + shrinkMargin;
+			bool const isTooLarge = node.Min.x < largestMin.x || node.Min.y < largestMin.y ||
+									largestMax.x < node.Max.x || largestMax.y < node.Max.y;
+			if (!isTooLarge)
+			{
+				return false;
+			}
+		}
+
+		node.Min = fatMin;
+		node.Max = fatMax;
+		return true;
+	}
+
+	void DynamicAABBTree::SetCategoryBits(std::int32_t proxyId, std::uint32_t categoryBits)
+	{
+		m_Nodes[proxyId].CategoryBits = categoryBits;
+
+		std::int32_t index = m_Nodes[proxyId].Parent;
+		while (index != NullNode)
+		{
+			Node& node = m_Nodes[index];
+			node.CategoryBits = m_Nodes[node.Child1].CategoryBits | m_Nodes[node.Child2].CategoryBits;
+			index = node.Parent;
+		}
+	}
+
+	void DynamicAABBTree::Clear()
+	{
+		m_Root = NullNode;
+		m_Nodes.clear();
+		m_FreeList = NullNode;
+		m_ProxyCount = 0;
+		m_RefittedLeafCount = 0;
+	}
+
+	std::int32_t DynamicAABBTree::GetHeight() const
+	{
+		if (m_Root == NullNode)
+		{
+			return 0;
+		}
+
+		return m_Nodes[m_Root].Height;
+	}
+
+	std::int32_t DynamicAABBTree::allocateNode()
+	{
+		if (m_FreeList == NullNode)
+		{
+			m_Nodes.emplace_back();
+			m_Nodes.back().Next = NullNode;
+			m_FreeList = (std::int32_t) m_Nodes.size() - 1;
+		}
+
+		std::int32_t const nodeId = m_FreeList;
+		Node& node = m_Nodes[nodeId];
+		m_FreeList = node.Next;
+
+		node.Parent = NullNode;
+		node.Child1 = NullNode;
+		node.Child2 = NullNode;
+		node.Height = 0;
+		node.UserData = -1;
+		node.CategoryBits = AllCategoryBits;
+
+		return nodeId;
+	}
+
+	void DynamicAABBTree::freeNode(std::int32_t node)
+	{
+		m_Nodes[node].Next = m_FreeList;
+		m_Nodes[node].Height = -1;
+		m_FreeList = node;
+	}
+
+	void DynamicAABBTree::insertLeaf(std::int32_t leaf)
+	{
+		if (m_Root == NullNode)
+		{
+			m_Root = leaf;
+			m_Nodes[m_Root].Parent = NullNode;
+			return;
+		}
+
+		// Find the best sibling for the leaf, using the perimeter as the cost (surface area heuristic in 2D).
+		glm::vec2 const leafMin = m_Nodes[leaf].Min;
+		glm::vec2 const leafMax = m_Nodes[leaf].Max;
+
+		std::int32_t index = m_Root;
+		while (!m_Nodes[index].IsLeaf())
+		{
+			Node const& node = m_Nodes[index];
+			std::int32_t const child1 = node.Child1;
+			std::int32_t const child2 = node.Child2;
+
+			float const area = perimeter(node.Min, node.Max);
+			float const combinedArea = perimeter(glm::min(node.Min, leafMin), glm::max(node.Max, leafMax));
+
+			// Cost of creating a new parent for this node and the new leaf.
+			float const cost = 2.0f * combinedArea;
+
+			// Minimum cost of pushing the leaf further down the tree.
+			float const inheritanceCost = 2.0f * (combinedArea - area);
+
+			auto descendCost = [&](std::int32_t child)
+			{
+				Node const& childNode = m_Nodes[child];
+				float const newArea = perimeter(glm::min(childNode.Min, leafMin), glm::max(childNode.Max, leafMax));
+				if (childNode.IsLeaf())
+				{
+					return newArea + inheritanceCost;
+				}
+
+				return (newArea - perimeter(childNode.Min, childNode.Max)) + inheritanceCost;
+			};
+
+			float const cost1 = descendCost(child1);
+			float const cost2 = descendCost(child2);
+
+			if (cost < cost1 && cost < cost2)
+			{
+				break;
+			}
+
+			index = cost1 < cost2? child1 : child2;
+		}
+
+		std::int32_t const sibling = index;
+
+		// Create a new parent for the sibling and the leaf.
+		std::int32_t const oldParent = m_Nodes[sibling].Parent;
+		std::int32_t const newParent = allocateNode();
+
+		Node& newParentNode = m_Nodes[newParent];
+		newParentNode.Parent = oldParent;
+		newParentNode.Min = glm::min(leafMin, m_Nodes[sibling].Min);
+		newParentNode.Max = glm::max(leafMax, m_Nodes[sibling].Max);
+		newParentNode.Height = m_Nodes[sibling].Height + 1;
+		newParentNode.CategoryBits = m_Nodes[leaf].CategoryBits | m_Nodes[sibling].CategoryBits;
+		newParentNode.Child1 = sibling;
+		newParentNode.Child2 = leaf;
+
+		if (oldParent != NullNode)
+		{
+			if (m_Nodes[oldParent].Child1 == sibling)
+			{
+				m_Nodes[oldParent].Child1 = newParent;
+			}
+			else
+			{
+				m_Nodes[oldParent].Child2 = newParent;
+			}
+		}
+		else
+		{
+			m_Root = newParent;
+		}
+
+		m_Nodes[sibling].Parent = newParent;
+		m_Nodes[leaf].Parent = newParent;
+
+		refitAncestors(m_Nodes[leaf].Parent);
+	}
+
+	void DynamicAABBTree::removeLeaf(std::int32_t leaf)
+	{
+		if (leaf == m_Root)
+		{
+			m_Root = NullNode;
+			return;
+		}
+
+		std::int32_t const parent = m_Nodes[leaf].Parent;
+		std::int32_t const grandParent = m_Nodes[parent].Parent;
+		std::int32_t const sibling = m_Nodes[parent].Child1 == leaf? m_Nodes[parent].Child2 : m_Nodes[parent].Child1;
+
+		if (grandParent == NullNode)
+		{
+			m_Root = sibling;
+			m_Nodes[sibling].Parent = NullNode;
+			freeNode(parent);
+			return;
+		}
+
+		// Destroy the parent and connect the sibling to the grand parent.
+		if (m_Nodes[grandParent].Child1 == parent)
+		{
+			m_Nodes[grandParent].Child1 = sibling;
+		}
+		else
+		{
+			m_Nodes[grandParent].Child2 = sibling;
+		}
+		m_Nodes[sibling].Parent = grandParent;
+		freeNode(parent);
+
+		refitAncestors(grandParent);
+	}
+
+	void DynamicAABBTree::refitAncestors(std::int32_t node)
+	{
+		std::int32_t index = node;
+		while (index != NullNode)
+		{
+			index = balance(index);
+
+			Node& current = m_Nodes[index];
+			Node const& child1 = m_Nodes[current.Child1];
+			Node const& child2 = m_Nodes[current.Child2];
+
+			current.Height = 1 + std::max(child1.Height, child2.Height);
+			current.Min = glm::min(child1.Min, child2.Min);
+			current.Max = glm::max(child1.Max, child2.Max);
+			current.CategoryBits = child1.CategoryBits | child2.CategoryBits;
+
+			index = current.Parent;
+		}
+	}
+
+	void DynamicAABBTree::refitAll()
+	{
+		// In pre-order every node comes before its children, walk the order backwards to refit the children first.
+		m_NodeOrder.clear();
+		m_NodeOrder.push_back(m_Root);
+		for (std::size_t i = 0; i < m_NodeOrder.size(); i++)
+		{
+			Node const& node = m_Nodes[m_NodeOrder[i]];
+			if (!node.IsLeaf())
+			{
+				m_NodeOrder.push_back(node.Child1);
+				m_NodeOrder.push_back(node.Child2);
+			}
+		}
+
+		for (auto itr = m_NodeOrder.rbegin(); itr != m_NodeOrder.rend(); ++itr)
+		{
+			Node& node = m_Nodes[*itr];
+			if (node.IsLeaf())
+			{
+				continue;
+			}
+
+			Node const& child1 = m_Nodes[node.Child1];
+			Node const& child2 = m_Nodes[node.Child2];
+			node.Min = glm::min(child1.Min, child2.Min);
+			node.Max = glm::max(child1.Max, child2.Max);
+			node.CategoryBits = child1.CategoryBits | child2.CategoryBits;
+		}
+	}
+
+	void DynamicAABBTree::rebuild()
+	{
+		m_NodeOrder.clear();
+		for (std::int32_t index = 0; index < (std::int32_t) m_Nodes.size(); index++)
+		{
+			if (m_Nodes[index].Height == 0)
+			{
+				m_NodeOrder.push_back(index);
+			}
+			else if (m_Nodes[index].Height > 0)
+			{
+				freeNode(index);
+			}
+		}
+
+		m_Root = NullNode;
+		for (std::int32_t const leaf : m_NodeOrder)
+		{
+			insertLeaf(leaf);
+		}
+		m_RefittedLeafCount = 0;
+	}
+
+	std::int32_t DynamicAABBTree::balance(std::int32_t iA)
+	{
+		// Perform a left or right rotation if node A is imbalanced.
+		// Returns the new root index of the subtree.
+		Node& A = m_Nodes[iA];
+		if (A.IsLeaf() || A.Height < 2)
+		{
+			return iA;
+		}
+
+		std::int32_t const iB = A.Child1;
+		std::int32_t const iC = A.Child2;
+		Node& B = m_Nodes[iB];
+		Node& C = m_Nodes[iC];
+
+		std::int32_t const balanceFactor = C.Height - B.Height;
+
+		auto rotateUp = [&](std::int32_t iUp, std::int32_t iDown, bool upIsChild2)
+		{
+			// iUp is the child of A that becomes the new subtree root, iDown is the other child of A.
+			Node& up = m_Nodes[iUp];
+			std::int32_t const iF = up.Child1;
+			std::int32_t const iG = up.Child2;
+			Node& F = m_Nodes[iF];
+			Node& G = m_Nodes[iG];
+
+			// Swap A and the rising child.
+			up.Child1 = iA;
+			up.Parent = A.Parent;
+			A.Parent = iUp;
+
+			// A's old parent should point to the rising child.
+			if (up.Parent != NullNode)
+			{
+				if (m_Nodes[up.Parent].Child1 == iA)
+				{
+					m_Nodes[up.Parent].Child1 = iUp;
+				}
+				else
+				{
+					m_Nodes[up.Parent].Child2 = iUp;
+				}
+			}
+			else
+			{
+				m_Root = iUp;
+			}
+
+			Node const& down = m_Nodes[iDown];
+
+			// Keep the taller grandchild under the rising child, give the other one to A.
+			std::int32_t const iKeep = F.Height > G.Height? iF : iG;
+			std::int32_t const iGive = F.Height > G.Height? iG : iF;
+
+			up.Child2 = iKeep;
+			if (upIsChild2)
+			{
+				A.Child2 = iGive;
+			}
+			else
+			{
+				A.Child1 = iGive;
+			}
+			m_Nodes[iGive].Parent = iA;
+
+			A.Min = glm::min(down.Min, m_Nodes[iGive].Min);
+			A.Max = glm::max(down.Max, m_Nodes[iGive].Max);
+			A.Height = 1 + std::max(down.Height, m_Nodes[iGive].Height);
+			A.CategoryBits = down.CategoryBits | m_Nodes[iGive].CategoryBits;
+
+			up.Min = glm::min(A.Min, m_Nodes[iKeep].Min);
+			up.Max = glm::max(A.Max, m_Nodes[iKeep].Max);
+			up.Height = 1 + std::max(A.Height, m_Nodes[iKeep].Height);
+			up.CategoryBits = A.CategoryBits | m_Nodes[iKeep].CategoryBits;
+		};
+
+		if (balanceFactor > 1)
+		{
+			// Rotate C up.
+			rotateUp(iC, iB, true);
+			return iC;
+		}
+
+		if (balanceFactor < -1)
+		{
+			// Rotate B up.
+			rotateUp(iB, iC, false);
+			return iB;
+		}
+
+		return iA;
+	}
+}
\ No newline at end of file
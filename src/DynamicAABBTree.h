@@ -0,0 +1,405 @@
+#pragma once
+
+#include "src/BroadPhase.h"
+
+#include "Math/AABB.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace DYE
+{
+	/// A dynamic bounding volume tree for 2D broad-phase queries.
+	/// Each leaf stores a fattened AABB, so a proxy can move a little without changing the tree structure.
+	/// The tree is kept balanced with rotations, queries are O(log n) on average.
+	class DynamicAABBTree
+	{
+	public:
+		constexpr static std::int32_t NullNode = -1;
+		constexpr static std::uint32_t AllCategoryBits = ~0u;
+
+		explicit DynamicAABBTree(float fatMargin = 0.1f);
+
+		/// Create a proxy for the given AABB.
+		/// \param categoryBits the layers the proxy belongs to, internal nodes store the union of their subtree
+		/// so a traversal with a category mask can skip whole subtrees.
+		/// \return the id of the proxy (a leaf node), use it to move or destroy the proxy.
+		std::int32_t CreateProxy(Math::AABB const& aabb, std::int32_t userData, std::uint32_t categoryBits = AllCategoryBits);
+		void DestroyProxy(std::int32_t proxyId);
+
+		/// Update the bounds of the proxy. If the new AABB is still inside the fattened AABB, nothing happens.
+		/// Otherwise the leaf is removed and reinserted, and the ancestors are refitted.
+		/// \param predictedDisplacement how far the proxy is expected to move before its next update: the fattened AABB is stretched
+		/// along it, so a proxy moving at a steady velocity stays inside its leaf for several updates. A leaf that has become much
+		/// larger than needed, e.g. once the proxy has slowed down, is shrunk back.
+		/// \return true if the proxy has been reinserted.
+		bool MoveProxy(std::int32_t proxyId, Math::AABB const& aabb, glm::vec2 predictedDisplacement = {0, 0});
+
+		/// Update the bounds of many proxies, proxyIds[i] gets aabbs[i], and restore the tree once for the whole batch.
+		/// The proxies still inside their fattened AABB are skipped like in MoveProxy. If only a few of them left it, they are reinserted one by one;
+		/// otherwise they are fattened in place and the internal nodes are refitted in a single bottom-up pass. A refitted leaf stays where it was
+		/// in the tree even if it has moved far, so once as many leaves as there are proxies have been refitted, the tree is rebuilt by reinsertion.
+		/// \param predictedDisplacements empty, or the predicted displacement of each proxy as in MoveProxy.
+		/// \return the number of proxies that left their fattened AABB.
+		std::uint32_t MoveProxies(std::span<std::int32_t const> proxyIds, std::span<Math::AABB const> aabbs,
+								  std::span<glm::vec2 const> predictedDisplacements = {});
+
+		/// Change the layers of the proxy and update the unions of its ancestors.
+		void SetCategoryBits(std::int32_t proxyId, std::uint32_t categoryBits);
+
+		std::int32_t GetUserData(std::int32_t proxyId) const { return m_Nodes[proxyId].UserData; }
+		glm::vec2 GetFatMin(std::int32_t proxyId) const { return m_Nodes[proxyId].Min; }
+		glm::vec2 GetFatMax(std::int32_t proxyId) const { return m_Nodes[proxyId].Max; }
+
+		void Clear();
+
+		std::int32_t GetHeight() const;
+		std::int32_t GetProxyCount() const { return m_ProxyCount; }
+
+		/// Find all the proxies whose fattened AABB overlaps with the given box.
+		/// Only the proxies sharing a category bit with the category mask are visited, the same goes for the other traversals.
+		/// \param callback bool(std::int32_t userData), return false to stop the query.
+		template<typename Callback>
+		void Query(glm::vec2 min, glm::vec2 max, Callback&& callback, std::uint32_t categoryMask = AllCategoryBits) const;
+
+		/// Visit the proxies whose fattened AABB and every ancestor pass the node test, for traversals that aren't a single box or segment.
+		/// \param nodeTest bool(glm::vec2 min, glm::vec2 max), return false to skip the node and its subtree.
+		/// \param callback bool(std::int32_t userData), return false to stop the traversal.
+		template<typename NodeTest, typename Callback>
+		void Traverse(NodeTest&& nodeTest, Callback&& callback, std::uint32_t categoryMask = AllCategoryBits) const;
+
+		/// Cast a segment (optionally swept by a box of the given half extents) through the tree, leaves are visited front to back.
+		/// \param callback float(std::int32_t userData, float maxFraction), return the new max fraction to clip the segment,
+		/// return maxFraction to keep going, or return 0 to stop the cast.
+		template<typename Callback>
+		void RayCast(glm::vec2 start, glm::vec2 displacement, glm::vec2 halfExtents, Callback&& callback, std::uint32_t categoryMask = AllCategoryBits) const;
+
+		/// Branch and bound search of the proxies nearest to the point, the nearer child is always visited first
+		/// and the subtrees farther than the current bound are skipped.
+		/// \param callback float(std::int32_t userData, float maxDistanceSquared), return the new bound,
+		/// e.g. the squared distance to the proxy if it is nearer, or maxDistanceSquared to keep it.
+		/// \param maxDistanceSquared the proxies farther than this are never visited.
+		template<typename Callback>
+		void QueryNearest(glm::vec2 point, Callback&& callback, std::uint32_t categoryMask = AllCategoryBits,
+						  float maxDistanceSquared = std::numeric_limits<float>::infinity()) const;
+
+	private:
+		struct Node
+		{
+			glm::vec2 Min;
+			glm::vec2 Max;
+
+			union
+			{
+				std::int32_t Parent;
+				std::int32_t Next;
+			};
+
+			std::int32_t Child1 = NullNode;
+			std::int32_t Child2 = NullNode;
+
+			// Leaf = 0, free node = -1.
+			std::int32_t Height = -1;
+			std::int32_t UserData = -1;
+
+			// The layers of the proxy for a leaf, the union of the layers in the subtree otherwise.
+			std::uint32_t CategoryBits = AllCategoryBits;
+
+			bool IsLeaf() const { return Child1 == NullNode; }
+		};
+
+		/// A traversal stack that lives on the call stack for common tree heights, so queries don't allocate.
+		template<typename T>
+		class NodeStack
+		{
+		public:
+			void Push(T const& element)
+			{
+				if (m_Count < m_InlineStack.size())
+				{
+					m_InlineStack[m_Count] = element;
+				}
+				else
+				{
+					m_OverflowStack.push_back(element);
+				}
+				m_Count++;
+			}
+
+			T Pop()
+			{
+				m_Count--;
+				if (m_Count < m_InlineStack.size())
+				{
+					return m_InlineStack[m_Count];
+				}
+
+				T const element = m_OverflowStack.back();
+				m_OverflowStack.pop_back();
+				return element;
+			}
+
+			bool IsEmpty() const { return m_Count == 0; }
+
+		private:
+			std::array<T, 256> m_InlineStack;
+			std::vector<T> m_OverflowStack;
+			std::size_t m_Count = 0;
+		};
+
+		struct CastStackEntry
+		{
+			std::int32_t Node;
+			float EntryFraction;
+		};
+
+		struct NearestStackEntry
+		{
+			std::int32_t Node;
+			float DistanceSquared;
+		};
+
+		std::int32_t allocateNode();
+		void freeNode(std::int32_t node);
+
+		void insertLeaf(std::int32_t leaf);
+		void removeLeaf(std::int32_t leaf);
+		void refitAncestors(std::int32_t node);
+		std::int32_t balance(std::int32_t node);
+
+		/// Recompute the bounds and layers of every internal node from its children, the structure is kept.
+		void refitAll();
+		/// Reinsert every leaf into an empty tree.
+		void rebuild();
+
+		/// Set the fattened AABB of the leaf if the AABB has left it, or if the leaf is too large for the AABB.
+		bool fattenIfEscaped(std::int32_t proxyId, Math::AABB const& aabb, glm::vec2 predictedDisplacement);
+
+		static float perimeter(glm::vec2 min, glm::vec2 max) { return 2.0f * ((max.x - min.x) + (max.y - min.y)); }
+
+	private:
+		float m_FatMargin;
+
+		std::int32_t m_Root = NullNode;
+		std::vector<Node> m_Nodes;
+		std::int32_t m_FreeList = NullNode;
+		std::int32_t m_ProxyCount = 0;
+
+		// A leaf is only shrunk once it is larger than its fattened AABB grown by this many margins on each side,
+		// so a proxy slowing down gradually isn't reinserted on every update.
+		constexpr static float ShrinkMarginCount = 4.0f;
+
+		// Reinserting a leaf walks down and up the tree, refitting visits every node once:
+		// a batch moving more than one leaf in BatchRefitRatio refits instead.
+		constexpr static std::int32_t BatchRefitRatio = 8;
+		// The leaves refitted in place since the last rebuild, see MoveProxies().
+		std::int64_t m_RefittedLeafCount = 0;
+		// Kept between batches so they don't allocate.
+		std::vector<std::int32_t> m_EscapedLeaves;
+		std::vector<std::int32_t> m_NodeOrder;
+	};
+
+	template<typename Callback>
+	void DynamicAABBTree::Query(glm::vec2 min, glm::vec2 max, Callback&& callback, std::uint32_t categoryMask) const
+	{
+		if (m_Root == NullNode)
+		{
+			return;
+		}
+
+		NodeStack<std::int32_t> stack;
+		stack.Push(m_Root);
+
+		while (!stack.IsEmpty())
+		{
+			Node const& node = m_Nodes[stack.Pop()];
+			bool const noOverlap = node.Max.x < min.x || node.Min.x > max.x || node.Max.y < min.y || node.Min.y > max.y;
+			if (noOverlap || (node.CategoryBits & categoryMask) == 0)
+			{
+				continue;
+			}
+
+			if (node.IsLeaf())
+			{
+				bool const shouldContinue = callback(node.UserData);
+				if (!shouldContinue)
+				{
+					return;
+				}
+				continue;
+			}
+
+			stack.Push(node.Child1);
+			stack.Push(node.Child2);
+		}
+	}
+
+	template<typename NodeTest, typename Callback>
+	void DynamicAABBTree::Traverse(NodeTest&& nodeTest, Callback&& callback, std::uint32_t categoryMask) const
+	{
+		if (m_Root == NullNode)
+		{
+			return;
+		}
+
+		NodeStack<std::int32_t> stack;
+		stack.Push(m_Root);
+
+		while (!stack.IsEmpty())
+		{
+			Node const& node = m_Nodes[stack.Pop()];
+			if ((node.CategoryBits & categoryMask) == 0 || !nodeTest(node.Min, node.Max))
+			{
+				continue;
+			}
+
+			if (node.IsLeaf())
+			{
+				bool const shouldContinue = callback(node.UserData);
+				if (!shouldContinue)
+				{
+					return;
+				}
+				continue;
+			}
+
+			stack.Push(node.Child1);
+			stack.Push(node.Child2);
+		}
+	}
+
+	template<typename Callback>
+	void DynamicAABBTree::RayCast(glm::vec2 start, glm::vec2 displacement, glm::vec2 halfExtents, Callback&& callback, std::uint32_t categoryMask) const
+	{
+		if (m_Root == NullNode)
+		{
+			return;
+		}
+
+		BroadPhaseSegment const segment = BroadPhaseSegment::Create(start, displacement);
+		float maxFraction = 1.0f;
+
+		float rootEntryFraction;
+		Node const& root = m_Nodes[m_Root];
+		if ((root.CategoryBits & categoryMask) == 0 ||
+			!segment.IntersectBox(root.Min - halfExtents, root.Max + halfExtents, maxFraction, rootEntryFraction))
+		{
+			return;
+		}
+
+		// Nodes are visited front to back: the nearer child is always popped first,
+		// so once the callback clips the segment, the farther subtrees are rejected without being opened.
+		NodeStack<CastStackEntry> stack;
+		stack.Push({m_Root, rootEntryFraction});
+
+		while (!stack.IsEmpty())
+		{
+			CastStackEntry const entry = stack.Pop();
+			if (entry.EntryFraction > maxFraction)
+			{
+				continue;
+			}
+
+			Node const& node = m_Nodes[entry.Node];
+			if (node.IsLeaf())
+			{
+				float const newMaxFraction = callback(node.UserData, maxFraction);
+				if (newMaxFraction <= 0.0f)
+				{
+					return;
+				}
+				maxFraction = glm::min(maxFraction, newMaxFraction);
+				continue;
+			}
+
+			Node const& child1 = m_Nodes[node.Child1];
+			Node const& child2 = m_Nodes[node.Child2];
+
+			float entryFraction1;
+			float entryFraction2;
+			bool const hitChild1 = (child1.CategoryBits & categoryMask) != 0 &&
+								   segment.IntersectBox(child1.Min - halfExtents, child1.Max + halfExtents, maxFraction, entryFraction1);
+			bool const hitChild2 = (child2.CategoryBits & categoryMask) != 0 &&
+								   segment.IntersectBox(child2.Min - halfExtents, child2.Max + halfExtents, maxFraction, entryFraction2);
+
+			if (hitChild1 && hitChild2)
+			{
+				bool const isChild1Nearer = entryFraction1 <= entryFraction2;
+				stack.Push(isChild1Nearer? CastStackEntry {node.Child2, entryFraction2} : CastStackEntry {node.Child1, entryFraction1});
+				stack.Push(isChild1Nearer? CastStackEntry {node.Child1, entryFraction1} : CastStackEntry {node.Child2, entryFraction2});
+			}
+			else if (hitChild1)
+			{
+				stack.Push({node.Child1, entryFraction1});
+			}
+			else if (hitChild2)
+			{
+				stack.Push({node.Child2, entryFraction2});
+			}
+		}
+	}
+
+	template<typename Callback>
+	void DynamicAABBTree::QueryNearest(glm::vec2 point, Callback&& callback, std::uint32_t categoryMask, float maxDistanceSquared) const
+	{
+		if (m_Root == NullNode)
+		{
+			return;
+		}
+
+		Node const& root = m_Nodes[m_Root];
+		float const rootDistanceSquared = PointBoxDistanceSquared(point, root.Min, root.Max);
+		if ((root.CategoryBits & categoryMask) == 0 || rootDistanceSquared > maxDistanceSquared)
+		{
+			return;
+		}
+
+		// Same order as RayCast with the distance to the point instead of the entry fraction.
+		NodeStack<NearestStackEntry> stack;
+		stack.Push({m_Root, rootDistanceSquared});
+
+		while (!stack.IsEmpty())
+		{
+			NearestStackEntry const entry = stack.Pop();
+			if (entry.DistanceSquared > maxDistanceSquared)
+			{
+				continue;
+			}
+
+			Node const& node = m_Nodes[entry.Node];
+			if (node.IsLeaf())
+			{
+				maxDistanceSquared = glm::min(maxDistanceSquared, (float) callback(node.UserData, maxDistanceSquared));
+				continue;
+			}
+
+			Node const& child1 = m_Nodes[node.Child1];
+			Node const& child2 = m_Nodes[node.Child2];
+
+			float const distanceSquared1 = PointBoxDistanceSquared(point, child1.Min, child1.Max);
+			float const distanceSquared2 = PointBoxDistanceSquared(point, child2.Min, child2.Max);
+			bool const isChild1InRange = (child1.CategoryBits & categoryMask) != 0 && distanceSquared1 <= maxDistanceSquared;
+			bool const isChild2InRange = (child2.CategoryBits & categoryMask) != 0 && distanceSquared2 <= maxDistanceSquared;
+
+			if (isChild1InRange && isChild2InRange)
+			{
+				bool const isChild1Nearer = distanceSquared1 <= distanceSquared2;
+				stack.Push(isChild1Nearer? NearestStackEntry {node.Child2, distanceSquared2} : NearestStackEntry {node.Child1, distanceSquared1});
+				stack.Push(isChild1Nearer? NearestStackEntry {node.Child1, distanceSquared1} : NearestStackEntry {node.Child2, distanceSquared2});
+			}
+			else if (isChild1InRange)
+			{
+				stack.Push({node.Child1, distanceSquared1});
+			}
+			else if (isChild2InRange)
+			{
+				stack.Push({node.Child2, distanceSquared2});
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace DYE::ImGuiPagedList
+{
+	constexpr int DefaultPageSize = 1000;
+
+	/// Draw the page controls, then the rows of the current page in a scrolling child region.
+	/// Only the rows visible in the region are built, through a list clipper, so every row must have the same height.
+	/// \param rowCount the number of rows, the rows are indexed from 0.
+	/// \param page the current page, clamped to the pages there are.
+	/// \param drawRow void(std::uint32_t rowIndex), called for the visible rows only. It pushes its own ImGui ID,
+	/// keyed by what the row shows rather than by its index, so the widget state stays with the item when the rows shift.
+	template<typename DrawRow>
+	void Draw(char const* id, std::size_t rowCount, int& page, DrawRow&& drawRow, int pageSize = DefaultPageSize)
+	{
+		int const pageCount = std::max(1, ((int) rowCount + pageSize - 1) / pageSize);
+		page = std::clamp(page, 0, pageCount - 1);
+
+		ImGui::PushID(id);
+		if (ImGui::Button("<"))
+		{
+			page = std::max(page - 1, 0);
+		}
+		ImGui::SameLine();
+		ImGui::Text("Page %d / %d, %d rows", page + 1, pageCount, (int) rowCount);
+		ImGui::SameLine();
+		if (ImGui::Button(">"))
+		{
+			page = std::min(page + 1, pageCount - 1);
+		}
+
+		std::size_t const pageBegin = std::min(rowCount, (std::size_t) page * pageSize);
+		std::size_t const pageEnd = std::min(rowCount, pageBegin + pageSize);
+
+		if (ImGui::BeginChild("Rows"))
+		{
+			ImGuiListClipper clipper;
+			clipper.Begin((int) (pageEnd - pageBegin));
+			while (clipper.Step())
+			{
+				for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+				{
+					drawRow((std::uint32_t) (pageBegin + i));
+				}
+			}
+			clipper.End();
+		}
+		ImGui::EndChild();
+		ImGui::PopID();
+	}
+
+	/// Draw a list of rows given by key, e.g. the indices left by a filter. Each row is drawn under the ImGui ID of its key.
+	/// \param drawRow void(std::uint32_t row), called with the keys of the visible rows only.
+	template<typename DrawRow>
+	void Draw(char const* id, std::span<std::uint32_t const> rows, int& page, DrawRow&& drawRow, int pageSize = DefaultPageSize)
+	{
+		Draw(id, rows.size(), page, [&](std::uint32_t rowIndex)
+		{
+			std::uint32_t const row = rows[rowIndex];
+			ImGui::PushID((int) row);
+			drawRow(row);
+			ImGui::PopID();
+		}, pageSize);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+namespace DYE
+{
+	/// A vector storing up to N elements inline, it never allocates.
+	/// The member names follow the standard containers, so code reading query results works the same with a std::vector.
+	template<typename T, std::size_t N>
+	class InlineVector
+	{
+	public:
+		using value_type = T;
+		using iterator = T*;
+		using const_iterator = T const*;
+
+		constexpr static std::size_t capacity() { return N; }
+
+		std::size_t size() const { return m_Size; }
+		bool empty() const { return m_Size == 0; }
+		bool full() const { return m_Size == N; }
+
+		/// The vector must not be full.
+		void push_back(T const& element)
+		{
+			m_Elements[m_Size] = element;
+			m_Size++;
+		}
+
+		void pop_back() { m_Size--; }
+		void clear() { m_Size = 0; }
+
+		/// Shrink or grow the vector to the given size, which must not exceed the capacity.
+		/// The elements added by growing keep whatever value was last stored at their index.
+		void resize(std::size_t size) { m_Size = size; }
+
+		T& operator[](std::size_t index) { return m_Elements[index]; }
+		T const& operator[](std::size_t index) const { return m_Elements[index]; }
+
+		T& front() { return m_Elements[0]; }
+		T const& front() const { return m_Elements[0]; }
+		T& back() { return m_Elements[m_Size - 1]; }
+		T const& back() const { return m_Elements[m_Size - 1]; }
+
+		T* data() { return m_Elements.data(); }
+		T const* data() const { return m_Elements.data(); }
+
+		iterator begin() { return m_Elements.data(); }
+		iterator end() { return m_Elements.data() + m_Size; }
+		const_iterator begin() const { return m_Elements.data(); }
+		const_iterator end() const { return m_Elements.data() + m_Size; }
+
+		operator std::span<T>() { return {m_Elements.data(), m_Size}; }
+		operator std::span<T const>() const { return {m_Elements.data(), m_Size}; }
+
+	private:
+		std::array<T, N> m_Elements {};
+		std::size_t m_Size = 0;
+	};
+}
\ No newline at end of file
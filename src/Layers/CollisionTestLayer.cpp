@@ -1,6 +1,7 @@
 #include "CollisionTestLayer.h"
 
 #include "src/DYETechDemoApp.h"
+#include "src/Objects/WindowCamera.h"
 
 #include "Core/Application.h"
 #include "Util/Logger.h"
@@ -124,14 +125,16 @@ namespace DYE
 
     void CollisionTestLayer::OnUpdate()
     {
-		m_ColliderManager.DrawGizmos();
+		m_ColliderManager.DrawGizmos(MiniGame::WindowCamera::GetOrthographicViewBounds(*m_Camera, *WindowManager::GetMainWindow()));
 
 		Math::AABB const movingAABB = Math::AABB::CreateFromCenter(m_MovingObject->Position, {0.5f, 0.5f, 0.5f});
 		Math::AABB const averageAABB = Math::AABB::CreateFromCenter(m_AverageObject->Position, {0.5f, 0.5f, 0.5f});
 
 		float const circleRadius = 0.25f;
-		bool const isMovingOverlapped = !m_ColliderManager.OverlapCircle(m_MovingObject->Position, circleRadius).empty();
-		bool const isAverageOverlapped = !m_ColliderManager.OverlapCircle(m_AverageObject->Position, circleRadius).empty();
+		bool isMovingOverlapped = false;
+		m_ColliderManager.OverlapCircle(m_MovingObject->Position, circleRadius, [&isMovingOverlapped](ColliderID) { isMovingOverlapped = true; return false; });
+		bool isAverageOverlapped = false;
+		m_ColliderManager.OverlapCircle(m_AverageObject->Position, circleRadius, [&isAverageOverlapped](ColliderID) { isAverageOverlapped = true; return false; });
 
 		DebugDraw::Circle(m_MovingObject->Position, circleRadius, {0, 0, 1}, isMovingOverlapped? Color::Red : Color::Yellow);
 		DebugDraw::Circle(m_AverageObject->Position, circleRadius, {0, 0, 1}, isAverageOverlapped? Color::Red : Color::Yellow);
@@ -149,8 +152,8 @@ namespace DYE
 			DebugDraw::Circle(hitPoint3D, 0.05f, {0, 0, 1}, Color::Red);
 		}*/
 
-		auto hits = m_ColliderManager.CircleCastAll(rayStart, circleRadius, rayEnd - rayStart);
-		for (auto& hit : hits)
+		m_ColliderManager.CircleCastAll(rayStart, circleRadius, rayEnd - rayStart, m_CastHitsBuffer);
+		for (auto& hit : m_CastHitsBuffer)
 		{
 			glm::vec3 const hitPoint3D = {hit.Point.x, hit.Point.y, 0};
 			glm::vec3 const hitNormal3D = {hit.Normal.x, hit.Normal.y, 0};
@@ -159,7 +162,7 @@ namespace DYE
 			DebugDraw::Circle({hit.Centroid.x, hit.Centroid.y, 0}, circleRadius, {0, 0, 1}, Color::Red);
 		}
 
-		bool const hasIntersect = !hits.empty();
+		bool const hasIntersect = !m_CastHitsBuffer.empty();
 		DebugDraw::Line(m_MovingObject->Position, m_AverageObject->Position, hasIntersect? Color::Red : Color::Yellow);
 
 		// Scroll tiled offset
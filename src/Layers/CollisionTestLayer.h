@@ -72,6 +72,7 @@ namespace DYE
 		std::shared_ptr<SpriteObject> m_BackgroundTileObject;
 
 		ColliderManager m_ColliderManager;
+		std::vector<RaycastHit2D> m_CastHitsBuffer;
 
 		std::shared_ptr<DYE::Camera> m_Camera;
 	};
@@ -145,6 +145,8 @@ namespace DYE
 		switchToNormalMode();
 
 		m_WindowParticlesManager.Initialize(12);
+
+		m_PlatformColliderID = m_ColliderManager.RegisterAABB(getPlatformAABB());
 	}
 
 	void LandTheBallLayer::OnDetach()
@@ -154,6 +156,8 @@ namespace DYE
 		WindowManager::CloseWindow(m_pSlowMotionTimerBarWindow->GetWindowID());
 
 		m_WindowParticlesManager.Shutdown();
+
+		m_ColliderManager.UnregisterAABB(m_PlatformColliderID);
 	}
 
 	void LandTheBallLayer::OnUpdate()
@@ -363,7 +367,6 @@ namespace DYE
 		float const xChange = m_LandBall.Velocity.Value.x * timeStep;
 		float const yChange = m_LandBall.Velocity.Value.y * timeStep;
 
-		float const prevBallY = m_LandBall.Transform.Position.y;
 		float newBallY = m_LandBall.Transform.Position.y + yChange;
 		float const newBallX = m_LandBall.Transform.Position.x + xChange;
 
@@ -371,17 +374,13 @@ namespace DYE
 		{
 			gameOver();
 		}
-		else if (prevBallY >= PlatformY && newBallY < PlatformY)
+		else
 		{
-			// Reach the platform height! Check if the ball hits the platform.
-			float const minX = m_PlatformX - m_PlatformWidth * 0.5f;
-			float const maxX = m_PlatformX + m_PlatformWidth * 0.5f;
-
-			float const ballMinX = newBallX - m_LandBall.Transform.Scale.x * 0.5f;
-			float const ballMaxX = newBallX + m_LandBall.Transform.Scale.x * 0.5f;
-
-			bool const noOverlap = (maxX < ballMinX || ballMaxX < minX);
-			if (!noOverlap)
+			// Cast a flat box as wide as the ball from the ball position, the top of the platform is at PlatformY.
+			// Only a hit on the top face counts: the ball goes through the platform from below.
+			OrientedBox2D const ballBox = OrientedBox2D::CreateFromCenter(m_LandBall.Transform.Position, {m_LandBall.Transform.Scale.x, 0}, 0);
+			std::optional<RaycastHit2D> const platformHit = m_ColliderManager.BoxCast(ballBox, {xChange, yChange});
+			if (platformHit.has_value() && platformHit->Normal.y > 0.0f)
 			{
 				// Calculate new vertical launch speed and apply it.
 
@@ -401,6 +400,7 @@ namespace DYE
 					numberOfTriesAvailable--;
 				}
 				m_PlatformX = newPlatformX;
+				m_ColliderManager.SetAABB(m_PlatformColliderID, getPlatformAABB());
 
 				glm::vec2 contactPoint = m_LandBall.Transform.Position;
 				contactPoint.y -= m_LandBall.Transform.Scale.y * 0.5f;
@@ -463,6 +463,11 @@ namespace DYE
 		}
 	}
 
+	Math::AABB LandTheBallLayer::getPlatformAABB() const
+	{
+		return Math::AABB::CreateFromCenter({m_PlatformX, PlatformY - m_PlatformHeight * 0.5f, 0}, {m_PlatformWidth, m_PlatformHeight, 0});
+	}
+
 	void LandTheBallLayer::gameOver()
 	{
 		// Game-over logic.
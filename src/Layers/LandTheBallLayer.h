@@ -4,6 +4,7 @@
 
 #include "Graphics/Camera.h"
 
+#include "src/StaticColliderManager.h"
 #include "src/GizmosRippleEffectManager.h"
 #include "src/WindowParticlesManager.h"
 
@@ -64,6 +65,8 @@ namespace DYE
 
 		void gameOver();
 
+		Math::AABB getPlatformAABB() const;
+
 	public:
 		static std::uint32_t HighScore;
 
@@ -129,6 +132,10 @@ namespace DYE
 		WindowBase* m_pPlatformWindow = nullptr;
 		float m_PlatformX = 0.0f;
 
+		// Only holds the platform.
+		StaticColliderManager<1> m_ColliderManager;
+		ColliderID m_PlatformColliderID;
+
 		MiniGame::Transform m_BackgroundTransform;
 		MiniGame::Sprite m_BackgroundSprite;
 		constexpr static float m_BackgroundSlowMotionTransitionSpeed = 8.0f;
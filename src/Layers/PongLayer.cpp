@@ -1,6 +1,7 @@
 #include "src/Layers/PongLayer.h"
 
 #include "src/DYETechDemoApp.h"
+#include "src/ColliderSnapshot.h"
 
 #include "Core/Application.h"
 #include "Util/Logger.h"
@@ -55,6 +56,13 @@ namespace DYE
 		// Create ball objects.
 		m_Ball.Transform.Position = {0, 0, 0};
 		m_Ball.Collider.Radius = 0.25f;
+		m_ColliderManager.RegisterCircleCastRadius(m_Ball.Collider.Radius);
+		// The ball collider is only there to be detected by the homebase sensors and swept by the paddles, the ball itself moves with circle casts.
+		m_Ball.Collider.ID = m_ColliderManager.RegisterAABB
+		(
+			Math::AABB::CreateFromCenter(m_Ball.Transform.Position, glm::vec3 {2 * m_Ball.Collider.Radius, 2 * m_Ball.Collider.Radius, 1}),
+			CollisionFilter {.CategoryBits = BallCollisionLayer, .MaskBits = HomebaseCollisionLayer | PaddleCollisionLayer}
+		);
 		m_Ball.Velocity.Value = {5.0f, -0.5f};
 		m_Ball.LaunchBaseSpeed = 7;
 		m_Ball.Sprite.Texture = Texture2D::Create("assets\\Sprite_Pong.png");
@@ -97,7 +105,7 @@ namespace DYE
 			paddle.Sprite.Texture->PixelsPerUnit = 32;
 			paddle.Collider.Size = {mainPaddleWidth, 3, 1};
 
-			registerBoxCollider(paddle.Transform, paddle.Collider);
+			registerBoxCollider(paddle.Transform, paddle.Collider, CollisionFilter {.CategoryBits = PaddleCollisionLayer}, m_PlayerPaddles.size());
 			m_PlayerPaddles.emplace_back(paddle);
 		}
 
@@ -108,6 +116,12 @@ namespace DYE
 			homebase.PlayerID = player.Settings.ID;
 			homebase.Transform.Position = player.Settings.HomebaseCenter;
 			homebase.Collider.Size = player.Settings.HomebaseSize;
+			homebase.Collider.ID = m_ColliderManager.RegisterSensorAABB
+			(
+				homebase.GetAABB(),
+				CollisionFilter {.CategoryBits = HomebaseCollisionLayer, .MaskBits = BallCollisionLayer},
+				m_Homebases.size()
+			);
 
 			m_Homebases.emplace_back(homebase);
 		}
@@ -130,8 +144,9 @@ namespace DYE
 
 		for (auto& wall : m_Walls)
 		{
-			registerBoxCollider(wall.Transform, wall.Collider);
+			registerBoxCollider(wall.Transform, wall.Collider, CollisionFilter {.CategoryBits = WallCollisionLayer}, WallUserData, ColliderMobility::Static);
 		}
+		m_ColliderManager.BakeStaticColliders();
 
 		m_BorderSprite.Texture = Texture2D::Create("assets\\Sprite_PongBorder.png");
 		m_BorderSprite.Texture->PixelsPerUnit = 32;
@@ -229,7 +244,7 @@ namespace DYE
 		m_WindowParticlesManager.Shutdown();
 	}
 
-	void PongLayer::registerBoxCollider(MiniGame::Transform &transform, MiniGame::BoxCollider &collider)
+	void PongLayer::registerBoxCollider(MiniGame::Transform &transform, MiniGame::BoxCollider &collider, CollisionFilter filter, ColliderUserData userData, ColliderMobility mobility)
 	{
 		if (collider.ID.has_value() && m_ColliderManager.IsColliderRegistered(collider.ID.value()))
 		{
@@ -237,7 +252,7 @@ namespace DYE
 			return;
 		}
 
-		collider.ID = m_ColliderManager.RegisterAABB(Math::AABB::CreateFromCenter(transform.Position, collider.Size));
+		collider.ID = m_ColliderManager.RegisterAABB(Math::AABB::CreateFromCenter(transform.Position, collider.Size), filter, userData, mobility);
 	}
 
 	void PongLayer::unregisterBoxCollider(MiniGame::Transform &transform, MiniGame::BoxCollider &collider)
@@ -325,10 +340,18 @@ namespace DYE
 		m_FPSCounter.NewFrame(TIME.DeltaTime());
 		if (m_DrawColliderGizmos)
 		{
-			m_ColliderManager.DrawGizmos();
-			for (auto const& area : m_Homebases)
+			// Drawn from the snapshot of the last fixed step, the way a render thread would read the colliders.
+			// The homebases are sensors, they are drawn in yellow.
+			// The gizmos show up in every camera, only the colliders outside all of their views are skipped.
+			if (std::shared_ptr<ColliderManager::Snapshot const> const snapshot = m_ColliderManager.GetSnapshot())
 			{
-				DebugDraw::Cube(area.Transform.Position, area.Collider.Size, Color::Yellow);
+				Math::AABB viewBounds = MiniGame::WindowCamera::GetOrthographicViewBounds(m_MainCamera, *m_MainWindow);
+				for (Math::AABB const& playerViewBounds : {m_Player1WindowCamera.GetViewBounds(), m_Player2WindowCamera.GetViewBounds()})
+				{
+					viewBounds.Min = glm::min(viewBounds.Min, playerViewBounds.Min);
+					viewBounds.Max = glm::max(viewBounds.Max, playerViewBounds.Max);
+				}
+				snapshot->DrawGizmos(viewBounds);
 			}
 		}
 
@@ -647,17 +670,26 @@ namespace DYE
 			return;
 		}
 
-		m_ColliderManager.SetAABB(collider.ID.value(), Math::AABB::CreateFromCenter(transform.Position, collider.Size));
+		// Applied with the other paddles in OnFixedUpdate's batch.
+		ColliderID const id = collider.ID.value();
+		Math::AABB const aabb = Math::AABB::CreateFromCenter(transform.Position, collider.Size);
+		m_ColliderManager.SetAABBs({&id, 1}, {&aabb, 1});
 	}
 
 	void PongLayer::OnFixedUpdate()
 	{
 		auto const timeStep = (float) TIME.FixedDeltaTime();
+		// The paddles only sweep for the ball, none of them needs to see where the others have moved before the batch ends.
+		m_ColliderManager.BeginUpdate();
 		for (auto& paddle : m_PlayerPaddles)
 		{
 			updatePaddle(paddle, timeStep);
 		}
+		m_ColliderManager.EndUpdate();
 		updateBall(timeStep);
+		updateBallCollider();
+		m_ColliderManager.UpdateSensors();
+		m_ColliderManager.PublishSnapshot();
 
 		if (m_GameState == GameState::Playing)
 		{
@@ -702,9 +734,22 @@ namespace DYE
 		paddle.VelocityBuffer = isPaddleVelocityClamped? actualPositionOffsetInSecond : paddleVelocity;
 
 		// Push the ball if there is an overlap.
+		// The sweep finds the balls in the way with the broad-phase, the ball colliders are boxes so confirm each one with the circle.
+		bool isBallSwept = false;
+		m_ColliderManager.SweepAABB
+		(
+			paddle.GetAABB(), actualPositionOffset,
+			[this, &isBallSwept](RaycastHit2D const& hit)
+			{
+				isBallSwept = hit.ColliderID == m_Ball.Collider.ID;
+				return !isBallSwept;
+			},
+			CollisionFilter {.CategoryBits = PaddleCollisionLayer, .MaskBits = BallCollisionLayer}
+		);
+
 		Math::DynamicTestResult2D result2D;
-		bool const intersectBall = Math::MovingCircleAABBIntersect(m_Ball.Transform.Position, m_Ball.Collider.Radius,
-																   -actualPositionOffset, paddle.GetAABB(), result2D);
+		bool const intersectBall = isBallSwept && Math::MovingCircleAABBIntersect(m_Ball.Transform.Position, m_Ball.Collider.Radius,
+																				  -actualPositionOffset, paddle.GetAABB(), result2D);
 		if (intersectBall)
 		{
 			glm::vec2 const normal = glm::normalize(result2D.HitNormal);
@@ -748,53 +793,44 @@ namespace DYE
 			return;
 		}
 
-		// Ball collision detection.
-		glm::vec2 const positionChange = timeStep * m_Ball.Velocity.Value;
-		auto const& hits = m_ColliderManager.CircleCastAll(m_Ball.Transform.Position, 0.25f, positionChange);
-		if (!hits.empty())
-		{
-			auto const& hit = hits[0];
-			glm::vec2 const normal = glm::normalize(hit.Normal);
-
-			float const minimumTravelTimeAfterReflected = 0.001f;
-			float const reflectedTravelTime = glm::max(minimumTravelTimeAfterReflected, timeStep - hit.Time);
-			m_Ball.Velocity.Value = m_Ball.Velocity.Value - 2 * glm::dot(normal, m_Ball.Velocity.Value) * normal;
-			m_Ball.Transform.Position = glm::vec3(hit.Centroid + reflectedTravelTime * m_Ball.Velocity.Value, 0);
-
-			for (auto const& paddle : m_PlayerPaddles)
+		// Ball collision detection, the ball bounces as many times as needed to travel for the whole step.
+		CircleCastResolveResult const result = m_ColliderManager.CircleCastResolve
+		(
+			m_Ball.Transform.Position, m_Ball.Collider.Radius, m_Ball.Velocity.Value, timeStep,
+			[this](RaycastHit2D const& hit, glm::vec2& ballVelocity)
 			{
 				// If the box is a paddle, update velocity based on the paddle's state.
-				if (hit.ColliderID != paddle.Collider.ID)
+				// The ball only hits walls and paddles, anything but a wall is the paddle indexed by the user data.
+				bool const isPaddleHit = hit.UserData != WallUserData;
+				if (isPaddleHit)
 				{
-					continue;
-				}
+					auto const& paddle = m_PlayerPaddles[hit.UserData];
+					auto paddleVelocity = paddle.VelocityBuffer;
 
-				auto paddleVelocity = paddle.VelocityBuffer;
+					// Increase the horizontal speed if it's a paddle.
+					ballVelocity.x += glm::sign(ballVelocity.x) * paddle.HorizontalBallSpeedIncreasePerHit;
 
-				// Increase the horizontal speed if it's a paddle.
-				m_Ball.Velocity.Value.x += glm::sign(m_Ball.Velocity.Value.x) * paddle.HorizontalBallSpeedIncreasePerHit;
+					// Add paddle velocity to the ball.
+					ballVelocity += glm::vec2 {paddleVelocity.x, paddleVelocity.y};
 
-				// Add paddle velocity to the ball.
-				m_Ball.Velocity.Value += glm::vec2 {paddleVelocity.x, paddleVelocity.y};
+					if (glm::length2(ballVelocity) > m_Ball.MaxBallSpeed * m_Ball.MaxBallSpeed)
+					{
+						// Cap the ball speed to the max speed.
+						ballVelocity = glm::normalize(ballVelocity) * m_Ball.MaxBallSpeed;
+					}
 
-				if (glm::length2(m_Ball.Velocity.Value) > m_Ball.MaxBallSpeed * m_Ball.MaxBallSpeed)
-				{
-					// Cap the ball speed to the max speed.
-					m_Ball.Velocity.Value = glm::normalize(m_Ball.Velocity.Value) * m_Ball.MaxBallSpeed;
+					m_Ball.Hittable.LastHitByPlayerID = paddle.PlayerID;
+					m_Ball.PlayHitAnimation();
 				}
 
-				m_Ball.Hittable.LastHitByPlayerID = paddle.PlayerID;
-				m_Ball.PlayHitAnimation();
-
-				break;
-			}
+				playOnBounceEffect(hit.Point);
+			},
+			CollisionFilter {.CategoryBits = BallCollisionLayer, .MaskBits = WallCollisionLayer | PaddleCollisionLayer},
+			MaxBallBouncesPerStep
+		);
 
-			playOnBounceEffect(hit.Point);
-		}
-		else
-		{
-			m_Ball.Transform.Position += glm::vec3(positionChange, 0);
-		}
+		m_Ball.Transform.Position = glm::vec3(result.Center, 0);
+		m_Ball.Velocity.Value = result.Velocity;
 	}
 
 	void PongLayer::playOnBounceEffect(glm::vec2 worldPos)
@@ -831,11 +867,26 @@ namespace DYE
 		);
 	}
 
+	void PongLayer::updateBallCollider()
+	{
+		glm::vec3 const ballSize {2 * m_Ball.Collider.Radius, 2 * m_Ball.Collider.Radius, 1};
+		// The ball is the fastest collider, with its velocity the tree doesn't have to reinsert it on every step.
+		m_ColliderManager.SetVelocity(m_Ball.Collider.ID.value(), m_Ball.Velocity.Value);
+		m_ColliderManager.SetAABB(m_Ball.Collider.ID.value(), Math::AABB::CreateFromCenter(m_Ball.Transform.Position, ballSize));
+	}
+
 	void PongLayer::checkIfBallHasReachedGoal(float timeStep)
 	{
-		// Check if it's a goal.
-		for (auto const& homebase : m_Homebases)
+		// Check if it's a goal, the homebase sensors only detect the ball.
+		for (SensorEvent const& sensorEvent : m_ColliderManager.GetSensorEvents())
 		{
+			if (sensorEvent.Type == SensorEventType::Exit)
+			{
+				continue;
+			}
+
+			// The sensor tracks the bounds of the ball, confirm the contact with the circle.
+			auto const& homebase = m_Homebases[sensorEvent.SensorUserData];
 			if (!Math::AABBCircleIntersect(homebase.GetAABB(), m_Ball.Transform.Position, m_Ball.Collider.Radius))
 			{
 				continue;
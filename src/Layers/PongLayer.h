@@ -48,7 +48,8 @@ namespace DYE
 		void OnImGui() override;
 
 	private:
-		void registerBoxCollider(MiniGame::Transform& transform, MiniGame::BoxCollider& collider);
+		void registerBoxCollider(MiniGame::Transform& transform, MiniGame::BoxCollider& collider, CollisionFilter filter, ColliderUserData userData = 0,
+								 ColliderMobility mobility = ColliderMobility::Dynamic);
 		void unregisterBoxCollider(MiniGame::Transform& transform, MiniGame::BoxCollider& collider);
 		void renderSprite(MiniGame::Transform& transform, MiniGame::Sprite& sprite);
 
@@ -56,6 +57,7 @@ namespace DYE
 		void readPlayerInput(float timeStep);
 		void updatePaddle(MiniGame::PlayerPaddle& paddle, float timeStep);
 		void updateBall(float timeStep);
+		void updateBallCollider();
 		void checkIfBallHasReachedGoal(float timeStep);
 		void updateBoxCollider(MiniGame::Transform& transform, MiniGame::BoxCollider& collider);
 
@@ -99,7 +101,19 @@ namespace DYE
 		MiniGame::PlayerPaddle* m_pNextPaddleToSpawnBallAfterIntermission = nullptr;
 
 		// Game world
-		ColliderManager m_ColliderManager;
+		constexpr static std::uint32_t WallCollisionLayer = 1u << 0;
+		constexpr static std::uint32_t PaddleCollisionLayer = 1u << 1;
+		constexpr static std::uint32_t BallCollisionLayer = 1u << 2;
+		constexpr static std::uint32_t HomebaseCollisionLayer = 1u << 3;
+
+		// Paddle colliders carry the index of their paddle as user data, walls carry this so a hit tells them apart on its own.
+		constexpr static ColliderUserData WallUserData = ~ColliderUserData {0};
+
+		// Enough for a corner bounce followed by a paddle hit within one fixed step at the max ball speed.
+		constexpr static std::uint32_t MaxBallBouncesPerStep = 4;
+
+		// The arena is small and bounded, a coarse grid is cheaper to update than a tree.
+		ColliderManager m_ColliderManager {BroadPhaseSettings {.Type = BroadPhaseType::SpatialHashGrid, .SpatialHashGridCellSize = 4.0f}};
 		GizmosRippleEffectManager m_RippleEffectManager;
 		WindowParticlesManager m_WindowParticlesManager;
 
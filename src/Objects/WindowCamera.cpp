@@ -124,6 +124,14 @@ namespace DYE::MiniGame
 		return m_IsUpdatingResizeAnimation? AnimationUpdateResult::InProgress : AnimationUpdateResult::Complete;
 	}
 
+	Math::AABB WindowCamera::GetOrthographicViewBounds(DYE::Camera const& camera, WindowBase& window)
+	{
+		float const aspectRatio = camera.Properties.UseManualAspectRatio?
+								  camera.Properties.ManualAspectRatio : (float) window.GetWidth() / (float) window.GetHeight();
+		float const height = camera.Properties.OrthographicSize;
+		return Math::AABB::CreateFromCenter({camera.Position.x, camera.Position.y, 0}, {height * aspectRatio, height, 0});
+	}
+
 	void WindowCamera::UpdateCameraProperties()
 	{
 		glm::vec2 const windowPos = m_pWindow->GetPosition();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Graphics/Camera.h"
+#include "Math/AABB.h"
 #include "Math/EasingFunctions.h"
 
 namespace DYE
@@ -40,6 +41,13 @@ namespace DYE::MiniGame
 		AnimationUpdateResult UpdateWindowResizeAnimation(float timeStep);
 		void UpdateCameraProperties();
 
+		/// The world box seen by the camera through its window, e.g. to only draw the gizmos on screen.
+		Math::AABB GetViewBounds() const { return GetOrthographicViewBounds(Camera, *m_pWindow); }
+
+		/// The world box seen by an orthographic camera rendering to the given window.
+		/// The orthographic size is the height of the view, the width follows the aspect ratio of the camera or of the window.
+		static Math::AABB GetOrthographicViewBounds(DYE::Camera const& camera, WindowBase& window);
+
 	private:
 		WindowBase* m_pWindow = nullptr;
 
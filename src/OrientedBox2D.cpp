@@ -0,0 +1,144 @@
+#include "OrientedBox2D.h"
+
+#include <array>
+
+namespace DYE
+{
+	OrientedBox2D OrientedBox2D::CreateFromCenter(glm::vec2 center, glm::vec2 size, float rotation)
+	{
+		return OrientedBox2D {.Center = center, .HalfExtents = size * 0.5f, .AxisX = {glm::cos(rotation), glm::sin(rotation)}};
+	}
+
+	OrientedBox2D OrientedBox2D::CreateFromAABB(Math::AABB const& aabb)
+	{
+		glm::vec2 const min {aabb.Min.x, aabb.Min.y};
+		glm::vec2 const max {aabb.Max.x, aabb.Max.y};
+		return OrientedBox2D {.Center = (min + max) * 0.5f, .HalfExtents = (max - min) * 0.5f, .AxisX = {1, 0}};
+	}
+
+	Math::AABB OrientedBox2D::GetBounds() const
+	{
+		glm::vec2 const axisY = GetAxisY();
+		glm::vec2 const extents
+		{
+			HalfExtents.x * glm::abs(AxisX.x) + HalfExtents.y * glm::abs(axisY.x),
+			HalfExtents.x * glm::abs(AxisX.y) + HalfExtents.y * glm::abs(axisY.y)
+		};
+
+		Math::AABB bounds;
+		bounds.Min = glm::vec3 {Center - extents, 0};
+		bounds.Max = glm::vec3 {Center + extents, 0};
+		return bounds;
+	}
+
+	Math::AABB OrientedBox2D::GetLocalAABB() const
+	{
+		Math::AABB localAABB;
+		localAABB.Min = glm::vec3 {-HalfExtents, 0};
+		localAABB.Max = glm::vec3 {HalfExtents, 0};
+		return localAABB;
+	}
+
+	void OrientedBox2D::ToWorldResult(Math::DynamicTestResult2D& result) const
+	{
+		result.HitCentroid = ToWorldPoint(result.HitCentroid);
+		result.HitPoint = ToWorldPoint(result.HitPoint);
+		result.HitNormal = ToWorldDirection(result.HitNormal);
+	}
+
+	glm::vec2 OrientedBox2D::Support(glm::vec2 direction) const
+	{
+		glm::vec2 const axisY = GetAxisY();
+		return Center + AxisX * (HalfExtents.x * glm::sign(glm::dot(AxisX, direction)))
+					  + axisY * (HalfExtents.y * glm::sign(glm::dot(axisY, direction)));
+	}
+
+	bool OrientedBoxesIntersect(OrientedBox2D const& boxA, OrientedBox2D const& boxB)
+	{
+		std::array<glm::vec2, 4> const axes {boxA.AxisX, boxA.GetAxisY(), boxB.AxisX, boxB.GetAxisY()};
+		glm::vec2 const centerOffset = boxB.Center - boxA.Center;
+
+		for (glm::vec2 const axis : axes)
+		{
+			float const radius = boxA.ProjectedRadius(axis) + boxB.ProjectedRadius(axis);
+			if (glm::abs(glm::dot(centerOffset, axis)) > radius)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool MovingOrientedBoxIntersect(OrientedBox2D const& box, glm::vec2 displacement, OrientedBox2D const& target, Math::DynamicTestResult2D& result)
+	{
+		std::array<glm::vec2, 4> const axes {box.AxisX, box.GetAxisY(), target.AxisX, target.GetAxisY()};
+		glm::vec2 const centerOffset = target.Center - box.Center;
+
+		float tEnter = 0.0f;
+		float tExit = 1.0f;
+		int enterAxis = -1;
+		glm::vec2 normal {0, 0};
+
+		for (int axisIndex = 0; axisIndex < (int) axes.size(); axisIndex++)
+		{
+			glm::vec2 const axis = axes[axisIndex];
+			float const radius = box.ProjectedRadius(axis) + target.ProjectedRadius(axis);
+			float const distance = glm::dot(centerOffset, axis);
+			float const speed = glm::dot(displacement, axis);
+
+			// The projections overlap while |distance - speed * t| <= radius.
+			if (speed == 0.0f)
+			{
+				if (glm::abs(distance) > radius)
+				{
+					return false;
+				}
+				continue;
+			}
+
+			float t1 = (distance - radius) / speed;
+			float t2 = (distance + radius) / speed;
+			if (t1 > t2)
+			{
+				std::swap(t1, t2);
+			}
+
+			if (t1 > tEnter)
+			{
+				tEnter = t1;
+				enterAxis = axisIndex;
+				normal = speed > 0.0f? -axis : axis;
+			}
+
+			tExit = glm::min(tExit, t2);
+			if (tEnter > tExit)
+			{
+				return false;
+			}
+		}
+
+		result.HitTime = tEnter;
+		result.HitCentroid = box.Center + displacement * tEnter;
+		result.HitNormal = normal;
+
+		if (enterAxis < 0)
+		{
+			result.HitPoint = target.ClosestPoint(result.HitCentroid);
+		}
+		else if (enterAxis >= 2)
+		{
+			// Touching a face of the target, with the corner (or the edge) of the moving box the deepest into it.
+			OrientedBox2D movedBox = box;
+			movedBox.Center = result.HitCentroid;
+			result.HitPoint = movedBox.Support(-normal);
+		}
+		else
+		{
+			// Touching a face of the moving box, with the corner (or the edge) of the target the deepest into it.
+			result.HitPoint = target.Support(normal);
+		}
+
+		return true;
+	}
+}
\ No newline at end of file
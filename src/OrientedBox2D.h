@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Math/AABB.h"
+#include "Math/PrimitiveTest.h"
+
+#include <glm/glm.hpp>
+
+namespace DYE
+{
+	/// A 2D box rotated around its center.
+	/// The rotation is kept as the unit local x axis of the box, so the tests don't evaluate a sine and a cosine every time.
+	struct OrientedBox2D
+	{
+		glm::vec2 Center {0, 0};
+		glm::vec2 HalfExtents {0, 0};
+		// (cos(rotation), sin(rotation)), the local y axis is perpendicular to it.
+		glm::vec2 AxisX {1, 0};
+
+		/// \param size the full size of the box before the rotation.
+		/// \param rotation counterclockwise, in radians.
+		static OrientedBox2D CreateFromCenter(glm::vec2 center, glm::vec2 size, float rotation);
+		static OrientedBox2D CreateFromAABB(Math::AABB const& aabb);
+
+		glm::vec2 GetAxisY() const { return {-AxisX.y, AxisX.x}; }
+		float GetRotation() const { return glm::atan(AxisX.y, AxisX.x); }
+
+		/// The smallest axis-aligned box containing the box, used by the broad-phase.
+		Math::AABB GetBounds() const;
+
+		/// The box in its own space: centered at the origin and axis-aligned.
+		Math::AABB GetLocalAABB() const;
+
+		glm::vec2 ToLocalDirection(glm::vec2 direction) const { return {glm::dot(direction, AxisX), glm::dot(direction, GetAxisY())}; }
+		glm::vec2 ToLocalPoint(glm::vec2 point) const { return ToLocalDirection(point - Center); }
+		glm::vec2 ToWorldDirection(glm::vec2 localDirection) const { return AxisX * localDirection.x + GetAxisY() * localDirection.y; }
+		glm::vec2 ToWorldPoint(glm::vec2 localPoint) const { return Center + ToWorldDirection(localPoint); }
+
+		/// Bring the result of a test run against GetLocalAABB() back to world space, the hit time doesn't change.
+		void ToWorldResult(Math::DynamicTestResult2D& result) const;
+
+		/// The point of the box nearest to the given point, the point itself if it is inside the box.
+		glm::vec2 ClosestPoint(glm::vec2 point) const { return ToWorldPoint(glm::clamp(ToLocalPoint(point), -HalfExtents, HalfExtents)); }
+
+		/// The point of the box the farthest along the direction: a corner, or the middle of an edge perpendicular to the direction.
+		glm::vec2 Support(glm::vec2 direction) const;
+
+		/// Half the length of the projection of the box on the unit axis.
+		float ProjectedRadius(glm::vec2 axis) const
+		{
+			return HalfExtents.x * glm::abs(glm::dot(AxisX, axis)) + HalfExtents.y * glm::abs(glm::dot(GetAxisY(), axis));
+		}
+	};
+
+	/// Separating axis test between two oriented boxes, on the two axes of each box. Touching boxes intersect.
+	bool OrientedBoxesIntersect(OrientedBox2D const& boxA, OrientedBox2D const& boxB);
+
+	/// Separating axis test of a box moving along the displacement against a box that doesn't move.
+	/// On each axis the projections overlap during an interval of the motion, the boxes touch at the latest entry of all the intervals.
+	/// result.HitTime is the fraction of the displacement at which the boxes touch, 0 with a zero normal if they already overlap.
+	/// result.HitNormal is the axis the boxes touch on, pointing from the target towards the moving box.
+	/// result.HitCentroid is the center of the moving box at that time.
+	bool MovingOrientedBoxIntersect(OrientedBox2D const& box, glm::vec2 displacement, OrientedBox2D const& target, Math::DynamicTestResult2D& result);
+}
\ No newline at end of file
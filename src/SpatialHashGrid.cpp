@@ -0,0 +1,118 @@
+#include "SpatialHashGrid.h"
+
+#include <algorithm>
+
+namespace DYE
+{
+	SpatialHashGrid::SpatialHashGrid(float cellSize) : m_CellSize(cellSize), m_InverseCellSize(1.0f / cellSize)
+	{
+	}
+
+	std::int32_t SpatialHashGrid::CreateProxy(Math::AABB const& aabb, std::int32_t userData, std::uint32_t categoryBits)
+	{
+		std::int32_t proxyId;
+		if (m_FreeList != NullProxy)
+		{
+			proxyId = m_FreeList;
+			m_FreeList = m_Proxies[proxyId].Next;
+		}
+		else
+		{
+			proxyId = (std::int32_t) m_Proxies.size();
+			m_Proxies.emplace_back();
+		}
+
+		Proxy& proxy = m_Proxies[proxyId];
+		proxy.Min = {aabb.Min.x, aabb.Min.y};
+		proxy.Max = {aabb.Max.x, aabb.Max.y};
+		proxy.Cells = cellRangeOf(proxy.Min, proxy.Max);
+		proxy.UserData = userData;
+		proxy.CategoryBits = categoryBits;
+		proxy.Next = NullProxy;
+		proxy.IsInUse = true;
+
+		addToCells(proxyId, proxy.Cells);
+		return proxyId;
+	}
+
+	void SpatialHashGrid::DestroyProxy(std::int32_t proxyId)
+	{
+		if (proxyId < 0 || (std::size_t) proxyId >= m_Proxies.size() || !m_Proxies[proxyId].IsInUse)
+		{
+			return;
+		}
+
+		Proxy& proxy = m_Proxies[proxyId];
+		removeFromCells(proxyId, proxy.Cells);
+
+		proxy.IsInUse = false;
+		proxy.UserData = -1;
+		proxy.Next = m_FreeList;
+		m_FreeList = proxyId;
+	}
+
+	bool SpatialHashGrid::MoveProxy(std::int32_t proxyId, Math::AABB const& aabb)
+	{
+		Proxy& proxy = m_Proxies[proxyId];
+		proxy.Min = {aabb.Min.x, aabb.Min.y};
+		proxy.Max = {aabb.Max.x, aabb.Max.y};
+
+		CellRange const newCells = cellRangeOf(proxy.Min, proxy.Max);
+		if (newCells == proxy.Cells)
+		{
+			return false;
+		}
+
+		removeFromCells(proxyId, proxy.Cells);
+		proxy.Cells = newCells;
+		addToCells(proxyId, proxy.Cells);
+		return true;
+	}
+
+	void SpatialHashGrid::Clear()
+	{
+		m_Cells.clear();
+		m_Proxies.clear();
+		m_FreeList = NullProxy;
+		m_OccupiedCells.Min = {std::numeric_limits<std::int32_t>::max(), std::numeric_limits<std::int32_t>::max()};
+		m_OccupiedCells.Max = {std::numeric_limits<std::int32_t>::min(), std::numeric_limits<std::int32_t>::min()};
+	}
+
+	void SpatialHashGrid::addToCells(std::int32_t proxyId, CellRange const& range)
+	{
+		for (std::int32_t y = range.Min.y; y <= range.Max.y; y++)
+		{
+			for (std::int32_t x = range.Min.x; x <= range.Max.x; x++)
+			{
+				m_Cells[cellKeyOf({x, y})].push_back(proxyId);
+			}
+		}
+
+		m_OccupiedCells.Min = glm::min(m_OccupiedCells.Min, range.Min);
+		m_OccupiedCells.Max = glm::max(m_OccupiedCells.Max, range.Max);
+	}
+
+	void SpatialHashGrid::removeFromCells(std::int32_t proxyId, CellRange const& range)
+	{
+		for (std::int32_t y = range.Min.y; y <= range.Max.y; y++)
+		{
+			for (std::int32_t x = range.Min.x; x <= range.Max.x; x++)
+			{
+				auto const itr = m_Cells.find(cellKeyOf({x, y}));
+				if (itr == m_Cells.end())
+				{
+					continue;
+				}
+
+				// The order of proxies within a cell doesn't matter, swap and pop.
+				auto& proxies = itr->second;
+				auto const proxyItr = std::find(proxies.begin(), proxies.end(), proxyId);
+				if (proxyItr != proxies.end())
+				{
+					*proxyItr = proxies.back();
+					proxies.pop_back();
+				}
+			}
+		}
+	}
+}
\ No newline at end of file
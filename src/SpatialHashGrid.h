@@ -0,0 +1,310 @@
+#pragma once
+
+#include "src/BroadPhase.h"
+
+#include "Math/AABB.h"
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace DYE
+{
+	/// A uniform grid broad-phase, cells are stored sparsely in a hash map so the world doesn't have to be bounded.
+	/// A proxy is added to every cell its AABB touches. Works best when the colliders have similar sizes close to the cell size.
+	class SpatialHashGrid
+	{
+	public:
+		constexpr static std::int32_t NullProxy = -1;
+		constexpr static std::uint32_t AllCategoryBits = ~0u;
+
+		explicit SpatialHashGrid(float cellSize = 2.0f);
+
+		std::int32_t CreateProxy(Math::AABB const& aabb, std::int32_t userData, std::uint32_t categoryBits = AllCategoryBits);
+		void DestroyProxy(std::int32_t proxyId);
+
+		/// Update the bounds of the proxy, the cells are only touched if the covered cell range changes.
+		/// \return true if the proxy has been moved to different cells.
+		bool MoveProxy(std::int32_t proxyId, Math::AABB const& aabb);
+
+		void SetCategoryBits(std::int32_t proxyId, std::uint32_t categoryBits) { m_Proxies[proxyId].CategoryBits = categoryBits; }
+
+		std::int32_t GetUserData(std::int32_t proxyId) const { return m_Proxies[proxyId].UserData; }
+		float GetCellSize() const { return m_CellSize; }
+
+		void Clear();
+
+		/// Find all the proxies whose AABB overlaps with the given box. Each proxy is reported once.
+		/// Only the proxies sharing a category bit with the category mask are reported, the same goes for RayCast.
+		/// \param callback bool(std::int32_t userData), return false to stop the query.
+		template<typename Callback>
+		void Query(glm::vec2 min, glm::vec2 max, Callback&& callback, std::uint32_t categoryMask = AllCategoryBits) const;
+
+		/// Walk the cells along the segment with a DDA traversal, cells are visited front to back.
+		/// A box of the given half extents is swept along the segment, each step only scans the row or column of cells
+		/// that has just come within reach of the box. Each proxy is reported once.
+		/// \param callback float(std::int32_t userData, float maxFraction), return the new max fraction to clip the segment,
+		/// return maxFraction to keep going, or return 0 to stop the cast.
+		template<typename Callback>
+		void RayCast(glm::vec2 start, glm::vec2 displacement, glm::vec2 halfExtents, Callback&& callback, std::uint32_t categoryMask = AllCategoryBits) const;
+
+	private:
+		using CellKey = std::uint64_t;
+
+		// Relative to the cell size.
+		constexpr static float CastTolerance = 0.001f;
+
+		struct CellRange
+		{
+			glm::ivec2 Min;
+			glm::ivec2 Max;
+
+			bool Contains(glm::ivec2 cell) const { return cell.x >= Min.x && cell.x <= Max.x && cell.y >= Min.y && cell.y <= Max.y; }
+			bool Overlaps(CellRange const& other) const { return Min.x <= other.Max.x && other.Min.x <= Max.x && Min.y <= other.Max.y && other.Min.y <= Max.y; }
+			bool operator==(CellRange const& other) const { return Min == other.Min && Max == other.Max; }
+		};
+
+		struct Proxy
+		{
+			glm::vec2 Min;
+			glm::vec2 Max;
+			CellRange Cells;
+			std::int32_t UserData = -1;
+			std::uint32_t CategoryBits = AllCategoryBits;
+
+			// Index of the next free proxy when the proxy is not in use.
+			std::int32_t Next = NullProxy;
+			bool IsInUse = false;
+		};
+
+		static CellKey cellKeyOf(glm::ivec2 cell)
+		{
+			return ((CellKey) (std::uint32_t) cell.x << 32) | (CellKey) (std::uint32_t) cell.y;
+		}
+
+		glm::ivec2 cellOf(glm::vec2 point) const
+		{
+			return {(std::int32_t) glm::floor(point.x * m_InverseCellSize), (std::int32_t) glm::floor(point.y * m_InverseCellSize)};
+		}
+
+		CellRange cellRangeOf(glm::vec2 min, glm::vec2 max) const { return {cellOf(min), cellOf(max)}; }
+
+		void addToCells(std::int32_t proxyId, CellRange const& range);
+		void removeFromCells(std::int32_t proxyId, CellRange const& range);
+
+		std::vector<std::int32_t> const* tryGetCell(glm::ivec2 cell) const
+		{
+			auto const itr = m_Cells.find(cellKeyOf(cell));
+			return itr == m_Cells.end()? nullptr : &itr->second;
+		}
+
+	private:
+		float m_CellSize;
+		float m_InverseCellSize;
+
+		std::unordered_map<CellKey, std::vector<std::int32_t>> m_Cells;
+		std::vector<Proxy> m_Proxies;
+		std::int32_t m_FreeList = NullProxy;
+
+		// The union of all the cells that have ever been occupied, used to clip queries and casts.
+		CellRange m_OccupiedCells {
+			{std::numeric_limits<std::int32_t>::max(), std::numeric_limits<std::int32_t>::max()},
+			{std::numeric_limits<std::int32_t>::min(), std::numeric_limits<std::int32_t>::min()}
+		};
+	};
+
+	template<typename Callback>
+	void SpatialHashGrid::Query(glm::vec2 min, glm::vec2 max, Callback&& callback, std::uint32_t categoryMask) const
+	{
+		CellRange const queryRange = cellRangeOf(min, max);
+		CellRange const clippedRange {glm::max(queryRange.Min, m_OccupiedCells.Min), glm::min(queryRange.Max, m_OccupiedCells.Max)};
+
+		for (std::int32_t y = clippedRange.Min.y; y <= clippedRange.Max.y; y++)
+		{
+			for (std::int32_t x = clippedRange.Min.x; x <= clippedRange.Max.x; x++)
+			{
+				std::vector<std::int32_t> const* pCell = tryGetCell({x, y});
+				if (pCell == nullptr)
+				{
+					continue;
+				}
+
+				for (std::int32_t const proxyId : *pCell)
+				{
+					Proxy const& proxy = m_Proxies[proxyId];
+					if ((proxy.CategoryBits & categoryMask) == 0)
+					{
+						continue;
+					}
+
+					// A proxy is in several cells, only report it in the first cell shared by the query and the proxy.
+					bool const isFirstSharedCell = x == glm::max(proxy.Cells.Min.x, clippedRange.Min.x) &&
+												   y == glm::max(proxy.Cells.Min.y, clippedRange.Min.y);
+					if (!isFirstSharedCell)
+					{
+						continue;
+					}
+
+					bool const noOverlap = proxy.Max.x < min.x || proxy.Min.x > max.x || proxy.Max.y < min.y || proxy.Min.y > max.y;
+					if (noOverlap)
+					{
+						continue;
+					}
+
+					bool const shouldContinue = callback(proxy.UserData);
+					if (!shouldContinue)
+					{
+						return;
+					}
+				}
+			}
+		}
+	}
+
+	template<typename Callback>
+	void SpatialHashGrid::RayCast(glm::vec2 start, glm::vec2 displacement, glm::vec2 halfExtents, Callback&& callback, std::uint32_t categoryMask) const
+	{
+		if (m_OccupiedCells.Min.x > m_OccupiedCells.Max.x)
+		{
+			// The grid has never been populated.
+			return;
+		}
+
+		// The swept box touches a proxy iff the segment touches the proxy inflated by the half extents,
+		// so every proxy it touches is in a cell within reach of the extents around one of the cells along the segment.
+		// The inflation is padded by a small tolerance so floating point errors in the walk never skip a grazing proxy.
+		glm::vec2 const paddedExtents = halfExtents + glm::vec2 {m_CellSize * CastTolerance, m_CellSize * CastTolerance};
+		glm::ivec2 const reach {(std::int32_t) glm::ceil(paddedExtents.x * m_InverseCellSize), (std::int32_t) glm::ceil(paddedExtents.y * m_InverseCellSize)};
+
+		// Clip the segment to the occupied part of the grid so long casts don't walk empty cells.
+		BroadPhaseSegment const segment = BroadPhaseSegment::Create(start, displacement);
+		glm::vec2 const occupiedMin = glm::vec2 {(float) m_OccupiedCells.Min.x, (float) m_OccupiedCells.Min.y} * m_CellSize - paddedExtents;
+		glm::vec2 const occupiedMax = glm::vec2 {(float) m_OccupiedCells.Max.x + 1, (float) m_OccupiedCells.Max.y + 1} * m_CellSize + paddedExtents;
+
+		float maxFraction = 1.0f;
+		float fraction;
+		if (!segment.IntersectBox(occupiedMin, occupiedMax, maxFraction, fraction))
+		{
+			return;
+		}
+
+		glm::vec2 const entryPoint = start + displacement * fraction;
+		glm::ivec2 cell = cellOf(entryPoint);
+		glm::ivec2 const step {displacement.x > 0.0f? 1 : -1, displacement.y > 0.0f? 1 : -1};
+
+		// The fraction at which the segment crosses the next vertical/horizontal cell border.
+		glm::vec2 nextBorderFraction;
+		glm::vec2 borderFractionDelta;
+		for (int axis = 0; axis < 2; axis++)
+		{
+			if (displacement[axis] == 0.0f)
+			{
+				nextBorderFraction[axis] = std::numeric_limits<float>::infinity();
+				borderFractionDelta[axis] = std::numeric_limits<float>::infinity();
+				continue;
+			}
+
+			float const nextBorder = (float) (cell[axis] + (step[axis] > 0? 1 : 0)) * m_CellSize;
+			nextBorderFraction[axis] = (nextBorder - start[axis]) / displacement[axis];
+			borderFractionDelta[axis] = m_CellSize / glm::abs(displacement[axis]);
+		}
+
+		// The cells within reach of the visited cell, and the part of them that hasn't been scanned at the previous steps:
+		// the whole neighbourhood for the first cell, then the row or column it has just moved into.
+		// The walk is monotonic so the band has never been within reach before, every cell is scanned once.
+		CellRange neighbourhood {cell - reach, cell + reach};
+		CellRange band = neighbourhood;
+		bool hasPreviousNeighbourhood = false;
+		CellRange previousNeighbourhood = neighbourhood;
+
+		while (fraction <= maxFraction)
+		{
+			CellRange const clippedBand {glm::max(band.Min, m_OccupiedCells.Min), glm::min(band.Max, m_OccupiedCells.Max)};
+			for (std::int32_t y = clippedBand.Min.y; y <= clippedBand.Max.y; y++)
+			{
+				for (std::int32_t x = clippedBand.Min.x; x <= clippedBand.Max.x; x++)
+				{
+					std::vector<std::int32_t> const* pCell = tryGetCell({x, y});
+					if (pCell == nullptr)
+					{
+						continue;
+					}
+
+					for (std::int32_t const proxyId : *pCell)
+					{
+						Proxy const& proxy = m_Proxies[proxyId];
+						if ((proxy.CategoryBits & categoryMask) == 0)
+						{
+							continue;
+						}
+
+						// Only report the proxy in the first of its cells in the band.
+						bool const isFirstSharedCell = x == glm::max(proxy.Cells.Min.x, clippedBand.Min.x) &&
+													   y == glm::max(proxy.Cells.Min.y, clippedBand.Min.y);
+						if (!isFirstSharedCell)
+						{
+							continue;
+						}
+
+						// The neighbourhood moves monotonically, so the steps at which it overlaps the cells of the proxy are contiguous:
+						// the proxy has already been scanned iff it was within reach at the previous step.
+						if (hasPreviousNeighbourhood && proxy.Cells.Overlaps(previousNeighbourhood))
+						{
+							continue;
+						}
+
+						float entryFraction;
+						if (!segment.IntersectBox(proxy.Min - halfExtents, proxy.Max + halfExtents, maxFraction, entryFraction))
+						{
+							continue;
+						}
+
+						float const newMaxFraction = callback(proxy.UserData, maxFraction);
+						if (newMaxFraction <= 0.0f)
+						{
+							return;
+						}
+						maxFraction = glm::min(maxFraction, newMaxFraction);
+					}
+				}
+			}
+
+			// Step into the next cell.
+			hasPreviousNeighbourhood = true;
+			previousNeighbourhood = neighbourhood;
+
+			int const axis = nextBorderFraction.x < nextBorderFraction.y? 0 : 1;
+			fraction = nextBorderFraction[axis];
+			nextBorderFraction[axis] += borderFractionDelta[axis];
+			cell[axis] += step[axis];
+			neighbourhood.Min[axis] += step[axis];
+			neighbourhood.Max[axis] += step[axis];
+
+			band = neighbourhood;
+			if (step[axis] > 0)
+			{
+				band.Min[axis] = neighbourhood.Max[axis];
+			}
+			else
+			{
+				band.Max[axis] = neighbourhood.Min[axis];
+			}
+
+			if (fraction > 1.0f || std::isinf(fraction))
+			{
+				return;
+			}
+
+			bool const isOutsideOccupiedCells = cell.x < m_OccupiedCells.Min.x - reach.x || cell.x > m_OccupiedCells.Max.x + reach.x ||
+												cell.y < m_OccupiedCells.Min.y - reach.y || cell.y > m_OccupiedCells.Max.y + reach.y;
+			if (isOutsideOccupiedCells)
+			{
+				return;
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include "StaticBVH.h"
+
+#include <algorithm>
+
+namespace DYE
+{
+	void StaticBVH::Build(std::span<Primitive const> primitives)
+	{
+		Clear();
+		if (primitives.empty())
+		{
+			return;
+		}
+
+		m_Primitives.assign(primitives.begin(), primitives.end());
+
+		// A binary tree with at least one primitive per leaf has fewer than 2n nodes.
+		m_Nodes.reserve(2 * m_Primitives.size());
+		buildNode(0, (std::uint32_t) m_Primitives.size());
+	}
+
+	void StaticBVH::Clear()
+	{
+		m_Nodes.clear();
+		m_Primitives.clear();
+	}
+
+	std::uint32_t StaticBVH::buildNode(std::uint32_t begin, std::uint32_t end)
+	{
+		std::uint32_t const nodeIndex = (std::uint32_t) m_Nodes.size();
+		m_Nodes.emplace_back();
+
+		Node node {.Min = m_Primitives[begin].Min, .Max = m_Primitives[begin].Max, .CategoryBits = 0, .SecondChildOrFirstPrimitive = 0, .PrimitiveCount = 0};
+		glm::vec2 centerMin = (m_Primitives[begin].Min + m_Primitives[begin].Max) * 0.5f;
+		glm::vec2 centerMax = centerMin;
+		for (std::uint32_t i = begin; i < end; i++)
+		{
+			Primitive const& primitive = m_Primitives[i];
+			node.Min = glm::min(node.Min, primitive.Min);
+			node.Max = glm::max(node.Max, primitive.Max);
+			node.CategoryBits |= primitive.CategoryBits;
+
+			glm::vec2 const center = (primitive.Min + primitive.Max) * 0.5f;
+			centerMin = glm::min(centerMin, center);
+			centerMax = glm::max(centerMax, center);
+		}
+
+		std::uint32_t const count = end - begin;
+		if (count <= MaxPrimitivesPerLeaf)
+		{
+			node.SecondChildOrFirstPrimitive = begin;
+			node.PrimitiveCount = count;
+			m_Nodes[nodeIndex] = node;
+			return nodeIndex;
+		}
+
+		// Split at the median center along the axis the centers are the most spread on, so the tree stays balanced.
+		int const axis = (centerMax.x - centerMin.x) >= (centerMax.y - centerMin.y)? 0 : 1;
+		std::uint32_t const middle = begin + count / 2;
+		std::nth_element(m_Primitives.begin() + begin, m_Primitives.begin() + middle, m_Primitives.begin() + end,
+						 [axis](Primitive const& primitiveA, Primitive const& primitiveB)
+						 {
+							 return primitiveA.Min[axis] + primitiveA.Max[axis] < primitiveB.Min[axis] + primitiveB.Max[axis];
+						 });
+
+		// The first child is built right after this node, the second child after the whole subtree of the first one.
+		buildNode(begin, middle);
+		node.SecondChildOrFirstPrimitive = buildNode(middle, end);
+		node.PrimitiveCount = 0;
+		m_Nodes[nodeIndex] = node;
+		return nodeIndex;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,312 @@
+#pragma once
+
+#include "src/BroadPhase.h"
+
+#include "Math/AABB.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace DYE
+{
+	/// A bounding volume hierarchy built once from a set of boxes that don't move, e.g. the walls of a level.
+	/// The nodes are stored in a flat array in depth-first order: the first child of a node is always the node right after it,
+	/// so traversals mostly read the array forward. There is no incremental update, build it again when the boxes change.
+	class StaticBVH
+	{
+	public:
+		constexpr static std::uint32_t AllCategoryBits = ~0u;
+
+		struct Primitive
+		{
+			glm::vec2 Min;
+			glm::vec2 Max;
+			std::int32_t UserData;
+			std::uint32_t CategoryBits = AllCategoryBits;
+		};
+
+		/// Replace the hierarchy with one built from the given primitives, with median splits along the longest axis.
+		void Build(std::span<Primitive const> primitives);
+		void Clear();
+
+		std::size_t GetPrimitiveCount() const { return m_Primitives.size(); }
+		std::size_t GetNodeCount() const { return m_Nodes.size(); }
+
+		/// Find all the primitives overlapping with the given box.
+		/// Only the primitives sharing a category bit with the category mask are visited, the same goes for the other traversals.
+		/// \param callback bool(std::int32_t userData), return false to stop the query.
+		template<typename Callback>
+		void Query(glm::vec2 min, glm::vec2 max, Callback&& callback, std::uint32_t categoryMask = AllCategoryBits) const;
+
+		/// Visit the primitives whose box and every ancestor pass the node test.
+		/// \param nodeTest bool(glm::vec2 min, glm::vec2 max), return false to skip the node and its subtree.
+		/// \param callback bool(std::int32_t userData), return false to stop the traversal.
+		template<typename NodeTest, typename Callback>
+		void Traverse(NodeTest&& nodeTest, Callback&& callback, std::uint32_t categoryMask = AllCategoryBits) const;
+
+		/// Cast a segment (optionally swept by a box of the given half extents) through the hierarchy, nodes are visited front to back.
+		/// \param callback float(std::int32_t userData, float maxFraction), return the new max fraction to clip the segment,
+		/// return maxFraction to keep going, or return 0 to stop the cast.
+		/// \param maxFraction the cast is limited to [0, maxFraction] of the segment from the start.
+		template<typename Callback>
+		void RayCast(glm::vec2 start, glm::vec2 displacement, glm::vec2 halfExtents, Callback&& callback,
+					 std::uint32_t categoryMask = AllCategoryBits, float maxFraction = 1.0f) const;
+
+		/// Branch and bound search of the primitives nearest to the point, nodes are visited nearest first.
+		/// \param callback float(std::int32_t userData, float maxDistanceSquared), return the new bound, or maxDistanceSquared to keep it.
+		/// \param maxDistanceSquared the primitives farther than this are never visited.
+		template<typename Callback>
+		void QueryNearest(glm::vec2 point, Callback&& callback, std::uint32_t categoryMask = AllCategoryBits,
+						  float maxDistanceSquared = std::numeric_limits<float>::infinity()) const;
+
+	private:
+		constexpr static std::uint32_t MaxPrimitivesPerLeaf = 4;
+
+		// Median splits keep the depth at log2(n / MaxPrimitivesPerLeaf) + 1, far below this.
+		constexpr static std::size_t MaxStackSize = 64;
+
+		struct Node
+		{
+			glm::vec2 Min {0, 0};
+			glm::vec2 Max {0, 0};
+			// The union of the category bits of the primitives under the node.
+			std::uint32_t CategoryBits = 0;
+			// The second child for an internal node (the first child is the next node), the first primitive for a leaf.
+			std::uint32_t SecondChildOrFirstPrimitive = 0;
+			// 0 for an internal node.
+			std::uint32_t PrimitiveCount = 0;
+
+			bool IsLeaf() const { return PrimitiveCount > 0; }
+		};
+
+		struct CastStackEntry
+		{
+			std::uint32_t Node;
+			float EntryFraction;
+		};
+
+		struct NearestStackEntry
+		{
+			std::uint32_t Node;
+			float DistanceSquared;
+		};
+
+		std::uint32_t buildNode(std::uint32_t begin, std::uint32_t end);
+
+		static bool isOverlapping(glm::vec2 minA, glm::vec2 maxA, glm::vec2 minB, glm::vec2 maxB)
+		{
+			return minA.x <= maxB.x && maxA.x >= minB.x && minA.y <= maxB.y && maxA.y >= minB.y;
+		}
+
+	private:
+		std::vector<Node> m_Nodes;
+		std::vector<Primitive> m_Primitives;
+	};
+
+	template<typename Callback>
+	void StaticBVH::Query(glm::vec2 min, glm::vec2 max, Callback&& callback, std::uint32_t categoryMask) const
+	{
+		Traverse([min, max](glm::vec2 nodeMin, glm::vec2 nodeMax) { return isOverlapping(nodeMin, nodeMax, min, max); }, callback, categoryMask);
+	}
+
+	template<typename NodeTest, typename Callback>
+	void StaticBVH::Traverse(NodeTest&& nodeTest, Callback&& callback, std::uint32_t categoryMask) const
+	{
+		if (m_Nodes.empty())
+		{
+			return;
+		}
+
+		std::array<std::uint32_t, MaxStackSize> stack;
+		std::size_t stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			std::uint32_t const nodeIndex = stack[--stackSize];
+			Node const& node = m_Nodes[nodeIndex];
+			if ((node.CategoryBits & categoryMask) == 0 || !nodeTest(node.Min, node.Max))
+			{
+				continue;
+			}
+
+			if (!node.IsLeaf())
+			{
+				stack[stackSize++] = node.SecondChildOrFirstPrimitive;
+				stack[stackSize++] = nodeIndex + 1;
+				continue;
+			}
+
+			for (std::uint32_t i = node.SecondChildOrFirstPrimitive; i < node.SecondChildOrFirstPrimitive + node.PrimitiveCount; i++)
+			{
+				Primitive const& primitive = m_Primitives[i];
+				if ((primitive.CategoryBits & categoryMask) == 0 || !nodeTest(primitive.Min, primitive.Max))
+				{
+					continue;
+				}
+
+				bool const shouldContinue = callback(primitive.UserData);
+				if (!shouldContinue)
+				{
+					return;
+				}
+			}
+		}
+	}
+
+	template<typename Callback>
+	void StaticBVH::RayCast(glm::vec2 start, glm::vec2 displacement, glm::vec2 halfExtents, Callback&& callback,
+							std::uint32_t categoryMask, float maxFraction) const
+	{
+		if (m_Nodes.empty())
+		{
+			return;
+		}
+
+		BroadPhaseSegment const segment = BroadPhaseSegment::Create(start, displacement);
+
+		float rootEntryFraction;
+		Node const& root = m_Nodes[0];
+		if ((root.CategoryBits & categoryMask) == 0 ||
+			!segment.IntersectBox(root.Min - halfExtents, root.Max + halfExtents, maxFraction, rootEntryFraction))
+		{
+			return;
+		}
+
+		// Same front to back order as DynamicAABBTree::RayCast, the nearer child is always popped first.
+		std::array<CastStackEntry, MaxStackSize> stack;
+		std::size_t stackSize = 0;
+		stack[stackSize++] = {0, rootEntryFraction};
+
+		while (stackSize > 0)
+		{
+			CastStackEntry const entry = stack[--stackSize];
+			if (entry.EntryFraction > maxFraction)
+			{
+				continue;
+			}
+
+			Node const& node = m_Nodes[entry.Node];
+			if (node.IsLeaf())
+			{
+				for (std::uint32_t i = node.SecondChildOrFirstPrimitive; i < node.SecondChildOrFirstPrimitive + node.PrimitiveCount; i++)
+				{
+					Primitive const& primitive = m_Primitives[i];
+					float entryFraction;
+					if ((primitive.CategoryBits & categoryMask) == 0 ||
+						!segment.IntersectBox(primitive.Min - halfExtents, primitive.Max + halfExtents, maxFraction, entryFraction))
+					{
+						continue;
+					}
+
+					float const newMaxFraction = callback(primitive.UserData, maxFraction);
+					if (newMaxFraction <= 0.0f)
+					{
+						return;
+					}
+					maxFraction = glm::min(maxFraction, newMaxFraction);
+				}
+				continue;
+			}
+
+			std::uint32_t const child1 = entry.Node + 1;
+			std::uint32_t const child2 = node.SecondChildOrFirstPrimitive;
+
+			float entryFraction1;
+			float entryFraction2;
+			bool const hitChild1 = (m_Nodes[child1].CategoryBits & categoryMask) != 0 &&
+								   segment.IntersectBox(m_Nodes[child1].Min - halfExtents, m_Nodes[child1].Max + halfExtents, maxFraction, entryFraction1);
+			bool const hitChild2 = (m_Nodes[child2].CategoryBits & categoryMask) != 0 &&
+								   segment.IntersectBox(m_Nodes[child2].Min - halfExtents, m_Nodes[child2].Max + halfExtents, maxFraction, entryFraction2);
+
+			if (hitChild1 && hitChild2)
+			{
+				bool const isChild1Nearer = entryFraction1 <= entryFraction2;
+				stack[stackSize++] = isChild1Nearer? CastStackEntry {child2, entryFraction2} : CastStackEntry {child1, entryFraction1};
+				stack[stackSize++] = isChild1Nearer? CastStackEntry {child1, entryFraction1} : CastStackEntry {child2, entryFraction2};
+			}
+			else if (hitChild1)
+			{
+				stack[stackSize++] = {child1, entryFraction1};
+			}
+			else if (hitChild2)
+			{
+				stack[stackSize++] = {child2, entryFraction2};
+			}
+		}
+	}
+
+	template<typename Callback>
+	void StaticBVH::QueryNearest(glm::vec2 point, Callback&& callback, std::uint32_t categoryMask, float maxDistanceSquared) const
+	{
+		if (m_Nodes.empty())
+		{
+			return;
+		}
+
+		Node const& root = m_Nodes[0];
+		float const rootDistanceSquared = PointBoxDistanceSquared(point, root.Min, root.Max);
+		if ((root.CategoryBits & categoryMask) == 0 || rootDistanceSquared > maxDistanceSquared)
+		{
+			return;
+		}
+
+		std::array<NearestStackEntry, MaxStackSize> stack;
+		std::size_t stackSize = 0;
+		stack[stackSize++] = {0, rootDistanceSquared};
+
+		while (stackSize > 0)
+		{
+			NearestStackEntry const entry = stack[--stackSize];
+			if (entry.DistanceSquared > maxDistanceSquared)
+			{
+				continue;
+			}
+
+			Node const& node = m_Nodes[entry.Node];
+			if (node.IsLeaf())
+			{
+				for (std::uint32_t i = node.SecondChildOrFirstPrimitive; i < node.SecondChildOrFirstPrimitive + node.PrimitiveCount; i++)
+				{
+					Primitive const& primitive = m_Primitives[i];
+					if ((primitive.CategoryBits & categoryMask) == 0 || PointBoxDistanceSquared(point, primitive.Min, primitive.Max) > maxDistanceSquared)
+					{
+						continue;
+					}
+
+					maxDistanceSquared = glm::min(maxDistanceSquared, (float) callback(primitive.UserData, maxDistanceSquared));
+				}
+				continue;
+			}
+
+			std::uint32_t const child1 = entry.Node + 1;
+			std::uint32_t const child2 = node.SecondChildOrFirstPrimitive;
+
+			float const distanceSquared1 = PointBoxDistanceSquared(point, m_Nodes[child1].Min, m_Nodes[child1].Max);
+			float const distanceSquared2 = PointBoxDistanceSquared(point, m_Nodes[child2].Min, m_Nodes[child2].Max);
+			bool const isChild1InRange = (m_Nodes[child1].CategoryBits & categoryMask) != 0 && distanceSquared1 <= maxDistanceSquared;
+			bool const isChild2InRange = (m_Nodes[child2].CategoryBits & categoryMask) != 0 && distanceSquared2 <= maxDistanceSquared;
+
+			// Same order as RayCast with the distance to the point instead of the entry fraction.
+			if (isChild1InRange && isChild2InRange)
+			{
+				bool const isChild1Nearer = distanceSquared1 <= distanceSquared2;
+				stack[stackSize++] = isChild1Nearer? NearestStackEntry {child2, distanceSquared2} : NearestStackEntry {child1, distanceSquared1};
+				stack[stackSize++] = isChild1Nearer? NearestStackEntry {child1, distanceSquared1} : NearestStackEntry {child2, distanceSquared2};
+			}
+			else if (isChild1InRange)
+			{
+				stack[stackSize++] = {child1, distanceSquared1};
+			}
+			else if (isChild2InRange)
+			{
+				stack[stackSize++] = {child2, distanceSquared2};
+			}
+		}
+	}
+}
\ No newline at end of file
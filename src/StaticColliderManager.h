@@ -0,0 +1,716 @@
+#pragma once
+
+#include "src/ColliderManager.h"
+#include "src/InlineVector.h"
+#include "src/OrientedBox2D.h"
+
+#include "Math/AABB.h"
+#include "Math/PrimitiveTest.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+
+namespace DYE
+{
+	/// A collider manager for small worlds with a known max number of colliders, e.g. the Pong field.
+	/// The colliders live in fixed arrays indexed by the handle slot: nothing is allocated, and every query starts with
+	/// one branchless pass over the whole capacity that the compiler can unroll and vectorize, free slots included.
+	/// The registration, sensor and query API is the same as ColliderManager, and the narrow-phase is shared, so a layer can switch between the two.
+	/// Queries return an InlineVector instead of a std::vector; the std::vector buffer overloads, contact pairs, query batches
+	/// and ray packets stay ColliderManager features.
+	/// Every sensor keeps room for a contact with each collider, MaxSensorCount bounds that memory separately from the capacity.
+	template<std::size_t Capacity, std::size_t MaxSensorCount = std::min<std::size_t>(Capacity, 4)>
+	class StaticColliderManager
+	{
+		static_assert(Capacity > 0 && Capacity < ColliderID::InvalidIndex, "The capacity must fit in a collider handle.");
+		static_assert(MaxSensorCount <= Capacity, "There can't be more sensors than colliders.");
+
+		using Collider = ColliderManager::Collider;
+		using SensorContact = ColliderManager::SensorContact;
+		using CandidateMask = std::array<bool, Capacity>;
+
+	public:
+		/// The query results, a query can't return more results than there are colliders.
+		template<typename T>
+		using Results = InlineVector<T, Capacity>;
+
+		/// Each sensor reports at most one event per contact of the last and of the current update.
+		constexpr static std::size_t MaxSensorEventCount = 2 * MaxSensorCount * Capacity;
+
+		StaticColliderManager()
+		{
+			m_Generations.fill(1);
+			m_IsInUse.fill(false);
+			m_QueryCategoryBits.fill(0);
+			m_MaskBits.fill(0);
+		}
+
+		/// \return an invalid handle if the manager is full.
+		/// The mobility only matters to SweepAABB, which skips static colliders. There is no BVH to bake.
+		ColliderID RegisterAABB(Math::AABB aabb, CollisionFilter filter = {}, ColliderUserData userData = 0,
+								ColliderMobility mobility = ColliderMobility::Dynamic)
+		{
+			return registerCollider(aabb, filter, userData, false, mobility == ColliderMobility::Static);
+		}
+
+		ColliderID RegisterOBB(OrientedBox2D const& box, CollisionFilter filter = {}, ColliderUserData userData = 0,
+							   ColliderMobility mobility = ColliderMobility::Dynamic)
+		{
+			ColliderID const id = registerCollider(box.GetBounds(), filter, userData, false, mobility == ColliderMobility::Static);
+			if (id.IsValid())
+			{
+				m_Colliders[id.Index].OrientedBox = box;
+				m_Colliders[id.Index].IsOriented = true;
+			}
+			return id;
+		}
+
+		/// \return an invalid handle if the manager is full, or if there are already MaxSensorCount sensors.
+		ColliderID RegisterSensorAABB(Math::AABB aabb, CollisionFilter filter = {}, ColliderUserData userData = 0)
+		{
+			if (m_Sensors.full())
+			{
+				return {};
+			}
+
+			ColliderID const id = registerCollider(aabb, filter, userData, true, false);
+			if (id.IsValid())
+			{
+				m_Sensors.push_back(Sensor {.SlotIndex = id.Index, .Contacts = {}});
+			}
+			return id;
+		}
+
+		void UnregisterAABB(ColliderID id)
+		{
+			if (!IsColliderRegistered(id))
+			{
+				return;
+			}
+
+			// Like ColliderManager, the contacts of an unregistered sensor are dropped without exit events.
+			if (m_Colliders[id.Index].IsSensor)
+			{
+				auto const sensorItr = std::find_if(m_Sensors.begin(), m_Sensors.end(), [id](Sensor const& sensor) { return sensor.SlotIndex == id.Index; });
+				*sensorItr = m_Sensors.back();
+				m_Sensors.pop_back();
+			}
+			m_IsInUse[id.Index] = false;
+			m_QueryCategoryBits[id.Index] = 0;
+			m_MaskBits[id.Index] = 0;
+			m_Generations[id.Index]++;
+			m_ColliderCount--;
+		}
+
+		bool IsColliderRegistered(ColliderID id) const
+		{
+			return id.Index < Capacity && m_IsInUse[id.Index] && m_Generations[id.Index] == id.Generation;
+		}
+
+		/// The bounds of the collider, which is the collider itself unless it is oriented.
+		std::optional<Math::AABB> GetAABB(ColliderID id) const
+		{
+			if (!IsColliderRegistered(id))
+			{
+				return {};
+			}
+			return m_Colliders[id.Index].AABB;
+		}
+
+		/// Setting an AABB makes the collider axis-aligned again.
+		bool SetAABB(ColliderID id, Math::AABB aabb)
+		{
+			if (!IsColliderRegistered(id))
+			{
+				return false;
+			}
+
+			setBounds(id.Index, aabb);
+			m_Colliders[id.Index].OrientedBox = OrientedBox2D::CreateFromAABB(aabb);
+			m_Colliders[id.Index].IsOriented = false;
+			return true;
+		}
+
+		std::optional<OrientedBox2D> GetOBB(ColliderID id) const
+		{
+			if (!IsColliderRegistered(id))
+			{
+				return {};
+			}
+			return m_Colliders[id.Index].OrientedBox;
+		}
+
+		bool SetOBB(ColliderID id, OrientedBox2D const& box)
+		{
+			if (!IsColliderRegistered(id))
+			{
+				return false;
+			}
+
+			setBounds(id.Index, box.GetBounds());
+			m_Colliders[id.Index].OrientedBox = box;
+			m_Colliders[id.Index].IsOriented = true;
+			return true;
+		}
+
+		std::optional<CollisionFilter> GetCollisionFilter(ColliderID id) const
+		{
+			if (!IsColliderRegistered(id))
+			{
+				return {};
+			}
+			return m_Colliders[id.Index].Filter;
+		}
+
+		bool SetCollisionFilter(ColliderID id, CollisionFilter filter)
+		{
+			if (!IsColliderRegistered(id))
+			{
+				return false;
+			}
+
+			m_Colliders[id.Index].Filter = filter;
+			setFilterBits(id.Index);
+			return true;
+		}
+
+		std::optional<ColliderUserData> GetUserData(ColliderID id) const
+		{
+			if (!IsColliderRegistered(id))
+			{
+				return {};
+			}
+			return m_Colliders[id.Index].UserData;
+		}
+
+		bool SetUserData(ColliderID id, ColliderUserData userData)
+		{
+			if (!IsColliderRegistered(id))
+			{
+				return false;
+			}
+
+			m_Colliders[id.Index].UserData = userData;
+			return true;
+		}
+
+		bool IsSensor(ColliderID id) const
+		{
+			return IsColliderRegistered(id) && m_Colliders[id.Index].IsSensor;
+		}
+
+		std::optional<glm::vec2> ClosestPoint(ColliderID id, glm::vec2 point) const
+		{
+			if (!IsColliderRegistered(id))
+			{
+				return {};
+			}
+			return ColliderManager::closestPointOf(m_Colliders[id.Index], point);
+		}
+
+		/// Same events as ColliderManager::UpdateSensors(), the sensors are kept in the same order.
+		void UpdateSensors()
+		{
+			m_SensorEvents.clear();
+			for (Sensor& sensor : m_Sensors)
+			{
+				updateSensor(sensor);
+			}
+		}
+
+		std::span<SensorEvent const> GetSensorEvents() const { return m_SensorEvents; }
+
+		// Queries, see the ColliderManager counterparts.
+
+		Results<ColliderID> OverlapAABB(Math::AABB aabb, CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			Results<ColliderID> results;
+			OverlapAABB(aabb, [&results](ColliderID id) { results.push_back(id); return true; }, filter);
+			return results;
+		}
+
+		Results<ColliderID> OverlapCircle(glm::vec2 center, float radius, CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			Results<ColliderID> results;
+			OverlapCircle(center, radius, [&results](ColliderID id) { results.push_back(id); return true; }, filter);
+			return results;
+		}
+
+		Results<RaycastHit2D> RaycastAll(glm::vec2 start, glm::vec2 end, CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			Results<RaycastHit2D> hits;
+			RaycastAll(start, end, [&hits](RaycastHit2D const& hit) { hits.push_back(hit); return true; }, filter);
+			sortHits(hits);
+			return hits;
+		}
+
+		Results<RaycastHit2D> CircleCastAll(glm::vec2 center, float radius, glm::vec2 direction, CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			Results<RaycastHit2D> hits;
+			CircleCastAll(center, radius, direction, [&hits](RaycastHit2D const& hit) { hits.push_back(hit); return true; }, filter);
+			sortHits(hits);
+			return hits;
+		}
+
+		Results<RaycastHit2D> SweepAABB(Math::AABB aabb, glm::vec2 delta, CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			Results<RaycastHit2D> hits;
+			SweepAABB(aabb, delta, [&hits](RaycastHit2D const& hit) { hits.push_back(hit); return true; }, filter);
+			sortHits(hits);
+			return hits;
+		}
+
+		Results<RaycastHit2D> BoxCastAll(OrientedBox2D const& box, glm::vec2 direction, CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			Results<RaycastHit2D> hits;
+			BoxCastAll(box, direction, [&hits](RaycastHit2D const& hit) { hits.push_back(hit); return true; }, filter);
+			sortHits(hits);
+			return hits;
+		}
+
+		std::optional<RaycastHit2D> Raycast(glm::vec2 start, glm::vec2 end, CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			std::optional<RaycastHit2D> nearestHit;
+			RaycastAll(start, end, [&nearestHit](RaycastHit2D const& hit) { keepNearestHit(nearestHit, hit); return true; }, filter);
+			return nearestHit;
+		}
+
+		std::optional<RaycastHit2D> CircleCast(glm::vec2 center, float radius, glm::vec2 direction, CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			std::optional<RaycastHit2D> nearestHit;
+			CircleCastAll(center, radius, direction, [&nearestHit](RaycastHit2D const& hit) { keepNearestHit(nearestHit, hit); return true; }, filter);
+			return nearestHit;
+		}
+
+		std::optional<RaycastHit2D> BoxCast(OrientedBox2D const& box, glm::vec2 direction, CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			std::optional<RaycastHit2D> nearestHit;
+			BoxCastAll(box, direction, [&nearestHit](RaycastHit2D const& hit) { keepNearestHit(nearestHit, hit); return true; }, filter);
+			return nearestHit;
+		}
+
+		template<typename HitCallback> requires std::invocable<HitCallback&, RaycastHit2D const&, glm::vec2&>
+		CircleCastResolveResult CircleCastResolve(glm::vec2 center, float radius, glm::vec2 velocity, float time, HitCallback&& onHit,
+												  CollisionFilter filter = CollisionFilter::Everything(),
+												  std::uint32_t maxCasts = ColliderManager::DefaultMaxResolveCasts) const
+		{
+			auto castCircle = [&](glm::vec2 castCenter, glm::vec2 displacement, std::span<ColliderID const> ignoredIDs)
+			{
+				std::optional<RaycastHit2D> nearestHit;
+				CircleCastAll(castCenter, radius, displacement, [&](RaycastHit2D const& hit)
+				{
+					if (std::find(ignoredIDs.begin(), ignoredIDs.end(), hit.ColliderID) == ignoredIDs.end())
+					{
+						keepNearestHit(nearestHit, hit);
+					}
+					return true;
+				}, filter);
+				return nearestHit;
+			};
+			return ColliderManager::resolveCircleCasts(center, velocity, time, castCircle, onHit, maxCasts);
+		}
+
+		// Callback variants, the colliders are visited in slot order.
+
+		template<typename Callback> requires OverlapCallback<Callback>
+		void OverlapAABB(Math::AABB aabb, Callback&& callback, CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			forEachCandidate(findCandidates(aabb.Min, aabb.Max, filter), [&](ColliderID id, Collider const& collider)
+			{
+				if (!ColliderManager::overlapCollider(collider, aabb))
+				{
+					return true;
+				}
+				return ColliderManager::invokeOverlapCallback(callback, id, collider);
+			});
+		}
+
+		template<typename Callback> requires OverlapCallback<Callback>
+		void OverlapCircle(glm::vec2 center, float radius, Callback&& callback, CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			glm::vec2 const extents {radius, radius};
+			forEachCandidate(findCandidates(center - extents, center + extents, filter), [&](ColliderID id, Collider const& collider)
+			{
+				if (!ColliderManager::overlapCollider(collider, center, radius))
+				{
+					return true;
+				}
+				return ColliderManager::invokeOverlapCallback(callback, id, collider);
+			});
+		}
+
+		template<typename Callback> requires std::predicate<Callback&, RaycastHit2D const&>
+		void RaycastAll(glm::vec2 start, glm::vec2 end, Callback&& callback, CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			glm::vec2 const direction = end - start;
+			float const maxDistance = glm::length(direction);
+
+			forEachCandidate(findCastCandidates(start, {0, 0}, direction, filter), [&](ColliderID id, Collider const& collider)
+			{
+				RaycastHit2D hit;
+				return !ColliderManager::raycastCollider(id, collider, start, direction, maxDistance, hit) || callback(hit);
+			});
+		}
+
+		template<typename Callback> requires std::predicate<Callback&, RaycastHit2D const&>
+		void CircleCastAll(glm::vec2 center, float radius, glm::vec2 direction, Callback&& callback, CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			forEachCandidate(findCastCandidates(center, {radius, radius}, direction, filter), [&](ColliderID id, Collider const& collider)
+			{
+				RaycastHit2D hit;
+				return !ColliderManager::circleCastCollider(id, collider, center, radius, direction, hit) || callback(hit);
+			});
+		}
+
+		template<typename Callback> requires std::predicate<Callback&, RaycastHit2D const&>
+		void SweepAABB(Math::AABB aabb, glm::vec2 delta, Callback&& callback, CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			glm::vec2 const center {(aabb.Min.x + aabb.Max.x) * 0.5f, (aabb.Min.y + aabb.Max.y) * 0.5f};
+			glm::vec2 const halfExtents {(aabb.Max.x - aabb.Min.x) * 0.5f, (aabb.Max.y - aabb.Min.y) * 0.5f};
+			BroadPhaseSegment const segment = BroadPhaseSegment::Create(center, delta);
+
+			forEachCandidate(findCastCandidates(center, halfExtents, delta, filter), [&](ColliderID id, Collider const& collider)
+			{
+				RaycastHit2D hit;
+				return collider.IsStatic || !ColliderManager::sweepAABBCollider(id, collider, halfExtents, segment, hit) || callback(hit);
+			});
+		}
+
+		template<typename Callback> requires std::predicate<Callback&, RaycastHit2D const&>
+		void BoxCastAll(OrientedBox2D const& box, glm::vec2 direction, Callback&& callback, CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			Math::AABB const bounds = box.GetBounds();
+			glm::vec2 const halfExtents {(bounds.Max.x - bounds.Min.x) * 0.5f, (bounds.Max.y - bounds.Min.y) * 0.5f};
+
+			forEachCandidate(findCastCandidates(box.Center, halfExtents, direction, filter), [&](ColliderID id, Collider const& collider)
+			{
+				RaycastHit2D hit;
+				return !ColliderManager::boxCastCollider(id, collider, box, direction, hit) || callback(hit);
+			});
+		}
+
+		// Span variants: write at most results.size() results, casts keep the nearest hits ordered by time.
+
+		std::size_t OverlapAABB(Math::AABB aabb, std::span<ColliderID> results, CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			std::size_t count = 0;
+			if (!results.empty())
+			{
+				OverlapAABB(aabb, [&](ColliderID id) { results[count++] = id; return count < results.size(); }, filter);
+			}
+			return count;
+		}
+
+		std::size_t OverlapCircle(glm::vec2 center, float radius, std::span<ColliderID> results, CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			std::size_t count = 0;
+			if (!results.empty())
+			{
+				OverlapCircle(center, radius, [&](ColliderID id) { results[count++] = id; return count < results.size(); }, filter);
+			}
+			return count;
+		}
+
+		std::size_t RaycastAll(glm::vec2 start, glm::vec2 end, std::span<RaycastHit2D> results, CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			return copyNearestHits(RaycastAll(start, end, filter), results);
+		}
+
+		std::size_t CircleCastAll(glm::vec2 center, float radius, glm::vec2 direction, std::span<RaycastHit2D> results, CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			return copyNearestHits(CircleCastAll(center, radius, direction, filter), results);
+		}
+
+		std::size_t SweepAABB(Math::AABB aabb, glm::vec2 delta, std::span<RaycastHit2D> results, CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			return copyNearestHits(SweepAABB(aabb, delta, filter), results);
+		}
+
+		std::size_t BoxCastAll(OrientedBox2D const& box, glm::vec2 direction, std::span<RaycastHit2D> results, CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			return copyNearestHits(BoxCastAll(box, direction, filter), results);
+		}
+
+		std::optional<ColliderDistance2D> NearestCollider(glm::vec2 point, float maxDistance = std::numeric_limits<float>::infinity(),
+														  CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			Results<ColliderDistance2D> const nearest = KNearest(point, 1, maxDistance, filter);
+			if (nearest.empty())
+			{
+				return {};
+			}
+			return nearest.front();
+		}
+
+		Results<ColliderDistance2D> KNearest(glm::vec2 point, std::size_t k, float maxDistance = std::numeric_limits<float>::infinity(),
+											 CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			// The distances to the bounds are a lower bound, computed for every slot in one pass like the other broad-phase tests.
+			std::array<float, Capacity> boundsDistancesSquared;
+			for (std::size_t i = 0; i < Capacity; i++)
+			{
+				boundsDistancesSquared[i] = PointBoxDistanceSquared(point, {m_MinX[i], m_MinY[i]}, {m_MaxX[i], m_MaxY[i]});
+			}
+
+			float const maxDistanceSquared = maxDistance * maxDistance;
+			CandidateMask candidates = findVisible(filter);
+			for (std::size_t i = 0; i < Capacity; i++)
+			{
+				candidates[i] = candidates[i] & (boundsDistancesSquared[i] <= maxDistanceSquared);
+			}
+
+			Results<ColliderDistance2D> results;
+			forEachCandidate(candidates, [&](ColliderID id, Collider const& collider)
+			{
+				glm::vec2 const closestPoint = ColliderManager::closestPointOf(collider, point);
+				float const distanceSquared = glm::dot(closestPoint - point, closestPoint - point);
+				if (distanceSquared <= maxDistanceSquared)
+				{
+					results.push_back(ColliderDistance2D {.ColliderID = id, .UserData = collider.UserData, .Distance = glm::sqrt(distanceSquared), .Point = closestPoint});
+				}
+				return true;
+			});
+
+			std::size_t const count = std::min(k, results.size());
+			std::partial_sort(results.begin(), results.begin() + count, results.end(),
+							  [](ColliderDistance2D const& resultA, ColliderDistance2D const& resultB) { return resultA.Distance < resultB.Distance; });
+			results.resize(count);
+			return results;
+		}
+
+		std::size_t KNearest(glm::vec2 point, std::span<ColliderDistance2D> results, float maxDistance = std::numeric_limits<float>::infinity(),
+							 CollisionFilter filter = CollisionFilter::Everything()) const
+		{
+			Results<ColliderDistance2D> const nearest = KNearest(point, results.size(), maxDistance, filter);
+			std::copy(nearest.begin(), nearest.end(), results.begin());
+			return nearest.size();
+		}
+
+		// Nothing is cached or baked here, these are kept so a layer can switch from a ColliderManager without changes.
+		void RegisterCircleCastRadius(float radius) {}
+		void UnregisterCircleCastRadius(float radius) {}
+		void BakeStaticColliders() const {}
+
+		std::size_t GetColliderCount() const { return m_ColliderCount; }
+		constexpr static std::size_t GetCapacity() { return Capacity; }
+
+		void DrawGizmos() const
+		{
+			for (std::size_t slotIndex = 0; slotIndex < Capacity; slotIndex++)
+			{
+				if (m_IsInUse[slotIndex])
+				{
+					ColliderManager::drawColliderGizmo(m_Colliders[slotIndex]);
+				}
+			}
+		}
+
+		void DrawGizmos(Math::AABB const& viewBounds) const
+		{
+			glm::vec2 const viewMin {viewBounds.Min.x, viewBounds.Min.y};
+			glm::vec2 const viewMax {viewBounds.Max.x, viewBounds.Max.y};
+			for (std::size_t slotIndex = 0; slotIndex < Capacity; slotIndex++)
+			{
+				if (m_IsInUse[slotIndex] && ColliderManager::isInView(m_Colliders[slotIndex], viewMin, viewMax))
+				{
+					ColliderManager::drawColliderGizmo(m_Colliders[slotIndex]);
+				}
+			}
+		}
+
+	private:
+		struct Sensor
+		{
+			std::uint32_t SlotIndex;
+			// The visitors overlapping at the last update, sorted by slot.
+			Results<SensorContact> Contacts;
+		};
+
+		ColliderID registerCollider(Math::AABB const& aabb, CollisionFilter const& filter, ColliderUserData userData, bool isSensor, bool isStatic)
+		{
+			auto const freeSlotItr = std::find(m_IsInUse.begin(), m_IsInUse.end(), false);
+			if (freeSlotItr == m_IsInUse.end())
+			{
+				return {};
+			}
+
+			std::uint32_t const slotIndex = (std::uint32_t) (freeSlotItr - m_IsInUse.begin());
+			m_Colliders[slotIndex] = Collider
+			{
+				.AABB = aabb,
+				.OrientedBox = OrientedBox2D::CreateFromAABB(aabb),
+				.Velocity = {0, 0},
+				.Filter = filter,
+				.UserData = userData,
+				.IsSensor = isSensor,
+				.IsStatic = isStatic
+			};
+			m_IsInUse[slotIndex] = true;
+			setBounds(slotIndex, aabb);
+			setFilterBits(slotIndex);
+			m_ColliderCount++;
+
+			return {slotIndex, m_Generations[slotIndex]};
+		}
+
+		void setBounds(std::uint32_t slotIndex, Math::AABB const& aabb)
+		{
+			m_Colliders[slotIndex].AABB = aabb;
+			m_MinX[slotIndex] = aabb.Min.x;
+			m_MinY[slotIndex] = aabb.Min.y;
+			m_MaxX[slotIndex] = aabb.Max.x;
+			m_MaxY[slotIndex] = aabb.Max.y;
+		}
+
+		/// Sensors are given no category for the queries, so the visibility test needs no sensor flag.
+		void setFilterBits(std::uint32_t slotIndex)
+		{
+			Collider const& collider = m_Colliders[slotIndex];
+			m_QueryCategoryBits[slotIndex] = collider.IsSensor? 0 : collider.Filter.CategoryBits;
+			m_MaskBits[slotIndex] = collider.Filter.MaskBits;
+		}
+
+		/// The colliders visible to the filter, free slots have no category so they are never visible.
+		CandidateMask findVisible(CollisionFilter const& filter) const
+		{
+			CandidateMask candidates;
+			for (std::size_t i = 0; i < Capacity; i++)
+			{
+				candidates[i] = ((filter.CategoryBits & m_MaskBits[i]) != 0) & ((m_QueryCategoryBits[i] & filter.MaskBits) != 0);
+			}
+			return candidates;
+		}
+
+		/// The visible colliders whose bounds overlap with the given box.
+		CandidateMask findCandidates(glm::vec2 min, glm::vec2 max, CollisionFilter const& filter) const
+		{
+			CandidateMask candidates = findVisible(filter);
+			for (std::size_t i = 0; i < Capacity; i++)
+			{
+				bool const isOverlapped = (m_MinX[i] <= max.x) & (m_MaxX[i] >= min.x) & (m_MinY[i] <= max.y) & (m_MaxY[i] >= min.y);
+				candidates[i] = candidates[i] & isOverlapped;
+			}
+			return candidates;
+		}
+
+		/// The visible colliders overlapping with the bounds of the whole cast, the narrow-phase tests the cast itself.
+		CandidateMask findCastCandidates(glm::vec2 start, glm::vec2 halfExtents, glm::vec2 displacement, CollisionFilter const& filter) const
+		{
+			glm::vec2 const end = start + displacement;
+			return findCandidates(glm::min(start, end) - halfExtents, glm::max(start, end) + halfExtents, filter);
+		}
+
+		/// \param callback bool(ColliderID id, Collider const& collider), return false to stop.
+		template<typename Callback>
+		void forEachCandidate(CandidateMask const& candidates, Callback&& callback) const
+		{
+			for (std::uint32_t slotIndex = 0; slotIndex < Capacity; slotIndex++)
+			{
+				if (candidates[slotIndex] && !callback(ColliderID {slotIndex, m_Generations[slotIndex]}, m_Colliders[slotIndex]))
+				{
+					return;
+				}
+			}
+		}
+
+		static void keepNearestHit(std::optional<RaycastHit2D>& nearestHit, RaycastHit2D const& hit)
+		{
+			if (!nearestHit.has_value() || hit.Time < nearestHit->Time)
+			{
+				nearestHit = hit;
+			}
+		}
+
+		static void sortHits(Results<RaycastHit2D>& hits)
+		{
+			std::sort(hits.begin(), hits.end(), [](RaycastHit2D const& hitA, RaycastHit2D const& hitB) { return hitA.Time < hitB.Time; });
+		}
+
+		/// \param hits sorted by time.
+		static std::size_t copyNearestHits(Results<RaycastHit2D> const& hits, std::span<RaycastHit2D> results)
+		{
+			std::size_t const count = std::min(hits.size(), results.size());
+			std::copy(hits.begin(), hits.begin() + count, results.begin());
+			return count;
+		}
+
+		void updateSensor(Sensor& sensor)
+		{
+			Collider const& sensorCollider = m_Colliders[sensor.SlotIndex];
+			ColliderID const sensorID {sensor.SlotIndex, m_Generations[sensor.SlotIndex]};
+
+			// Visited in slot order, so the contacts come out sorted like ColliderManager sorts them.
+			Results<SensorContact> currentContacts;
+			OverlapAABB(sensorCollider.AABB, [&currentContacts](ColliderID id, ColliderUserData userData)
+			{
+				currentContacts.push_back({id, userData});
+				return true;
+			}, sensorCollider.Filter);
+
+			auto addEvent = [&](SensorEventType type, SensorContact const& contact)
+			{
+				m_SensorEvents.push_back(SensorEvent
+				{
+					.Type = type,
+					.SensorID = sensorID,
+					.SensorUserData = sensorCollider.UserData,
+					.VisitorID = contact.ID,
+					.VisitorUserData = contact.UserData
+				});
+			};
+
+			// Both contact lists are sorted, walk them together to find the new, the kept and the lost contacts.
+			Results<SensorContact> const& previousContacts = sensor.Contacts;
+			std::size_t previousIndex = 0;
+			std::size_t currentIndex = 0;
+			while (previousIndex < previousContacts.size() || currentIndex < currentContacts.size())
+			{
+				if (currentIndex == currentContacts.size() ||
+					(previousIndex < previousContacts.size() && ColliderManager::isOrderedBefore(previousContacts[previousIndex].ID, currentContacts[currentIndex].ID)))
+				{
+					addEvent(SensorEventType::Exit, previousContacts[previousIndex]);
+					previousIndex++;
+				}
+				else if (previousIndex == previousContacts.size() || ColliderManager::isOrderedBefore(currentContacts[currentIndex].ID, previousContacts[previousIndex].ID))
+				{
+					addEvent(SensorEventType::Enter, currentContacts[currentIndex]);
+					currentIndex++;
+				}
+				else
+				{
+					addEvent(SensorEventType::Stay, currentContacts[currentIndex]);
+					previousIndex++;
+					currentIndex++;
+				}
+			}
+
+			sensor.Contacts = currentContacts;
+		}
+
+	private:
+		// Structure of arrays of the bounds and the filter bits, read by the branchless passes of the queries.
+		std::array<float, Capacity> m_MinX {};
+		std::array<float, Capacity> m_MinY {};
+		std::array<float, Capacity> m_MaxX {};
+		std::array<float, Capacity> m_MaxY {};
+		std::array<std::uint32_t, Capacity> m_QueryCategoryBits;
+		std::array<std::uint32_t, Capacity> m_MaskBits;
+
+		// Indexed by slot, a collider never moves while it is registered.
+		std::array<Collider, Capacity> m_Colliders {};
+		std::array<std::uint32_t, Capacity> m_Generations;
+		std::array<bool, Capacity> m_IsInUse;
+		std::size_t m_ColliderCount = 0;
+
+		// Unordered, removed by swap and pop like the sensors of ColliderManager.
+		InlineVector<Sensor, MaxSensorCount> m_Sensors;
+		InlineVector<SensorEvent, MaxSensorEventCount> m_SensorEvents;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,208 @@
+#include "SweepAndPrune.h"
+
+#include <algorithm>
+
+namespace DYE
+{
+	std::int32_t SweepAndPrune::CreateProxy(Math::AABB const& aabb, std::uint64_t userData, std::uint32_t categoryBits, std::uint32_t maskBits)
+	{
+		std::int32_t proxyId;
+		if (m_FreeList != NullProxy)
+		{
+			proxyId = m_FreeList;
+			m_FreeList = m_Proxies[proxyId].SortedIndexOrNext;
+		}
+		else
+		{
+			proxyId = (std::int32_t) m_Proxies.size();
+			m_Proxies.emplace_back();
+		}
+
+		Proxy& proxy = m_Proxies[proxyId];
+		proxy.UserData = userData;
+		proxy.IsInUse = true;
+		proxy.IsDestroyed = false;
+
+		// Appended at the end, the insertion sort of the next update moves the entry to its place.
+		proxy.SortedIndexOrNext = (std::int32_t) m_SortedEntries.size();
+		m_SortedEntries.push_back(SortedEntry
+		{
+			.MinX = aabb.Min.x,
+			.MaxX = aabb.Max.x,
+			.MinY = aabb.Min.y,
+			.MaxY = aabb.Max.y,
+			.CategoryBits = categoryBits,
+			.MaskBits = maskBits,
+			.ProxyId = proxyId
+		});
+
+		return proxyId;
+	}
+
+	void SweepAndPrune::DestroyProxy(std::int32_t proxyId)
+	{
+		if (proxyId < 0 || (std::size_t) proxyId >= m_Proxies.size() || !m_Proxies[proxyId].IsInUse || m_Proxies[proxyId].IsDestroyed)
+		{
+			return;
+		}
+
+		// The entry is removed from the sweep order in one pass at the next update.
+		m_Proxies[proxyId].IsDestroyed = true;
+		m_DestroyedProxies.push_back(proxyId);
+	}
+
+	void SweepAndPrune::MoveProxy(std::int32_t proxyId, Math::AABB const& aabb)
+	{
+		SortedEntry& entry = m_SortedEntries[m_Proxies[proxyId].SortedIndexOrNext];
+		entry.MinX = aabb.Min.x;
+		entry.MaxX = aabb.Max.x;
+		entry.MinY = aabb.Min.y;
+		entry.MaxY = aabb.Max.y;
+	}
+
+	void SweepAndPrune::SetFilterBits(std::int32_t proxyId, std::uint32_t categoryBits, std::uint32_t maskBits)
+	{
+		SortedEntry& entry = m_SortedEntries[m_Proxies[proxyId].SortedIndexOrNext];
+		entry.CategoryBits = categoryBits;
+		entry.MaskBits = maskBits;
+	}
+
+	void SweepAndPrune::Clear()
+	{
+		m_Proxies.clear();
+		m_FreeList = NullProxy;
+		m_DestroyedProxies.clear();
+		m_SortedEntries.clear();
+		m_Pairs.clear();
+		m_NewPairs.clear();
+		m_PairEvents.clear();
+	}
+
+	void SweepAndPrune::UpdatePairs()
+	{
+		removeDestroyedEntries();
+		sortEntries();
+		sweep();
+		addPairEvents();
+		std::swap(m_Pairs, m_NewPairs);
+
+		// The ended pairs have been reported with the user data of the destroyed proxies, the ids can be reused now.
+		for (std::int32_t const proxyId : m_DestroyedProxies)
+		{
+			Proxy& proxy = m_Proxies[proxyId];
+			proxy.IsInUse = false;
+			proxy.IsDestroyed = false;
+			proxy.SortedIndexOrNext = m_FreeList;
+			m_FreeList = proxyId;
+		}
+		m_DestroyedProxies.clear();
+	}
+
+	void SweepAndPrune::removeDestroyedEntries()
+	{
+		if (m_DestroyedProxies.empty())
+		{
+			return;
+		}
+
+		// Compact the entries in place, the relative order of the kept entries doesn't change.
+		std::size_t keptCount = 0;
+		for (std::size_t i = 0; i < m_SortedEntries.size(); i++)
+		{
+			SortedEntry const& entry = m_SortedEntries[i];
+			if (m_Proxies[entry.ProxyId].IsDestroyed)
+			{
+				continue;
+			}
+
+			m_Proxies[entry.ProxyId].SortedIndexOrNext = (std::int32_t) keptCount;
+			m_SortedEntries[keptCount] = entry;
+			keptCount++;
+		}
+		m_SortedEntries.resize(keptCount);
+	}
+
+	void SweepAndPrune::sortEntries()
+	{
+		// The entries are still sorted from the last update except for the ones that moved, an insertion sort is close to linear.
+		for (std::size_t i = 1; i < m_SortedEntries.size(); i++)
+		{
+			SortedEntry const entry = m_SortedEntries[i];
+			std::size_t j = i;
+			while (j > 0 && m_SortedEntries[j - 1].MinX > entry.MinX)
+			{
+				m_SortedEntries[j] = m_SortedEntries[j - 1];
+				m_Proxies[m_SortedEntries[j].ProxyId].SortedIndexOrNext = (std::int32_t) j;
+				j--;
+			}
+
+			if (j != i)
+			{
+				m_SortedEntries[j] = entry;
+				m_Proxies[entry.ProxyId].SortedIndexOrNext = (std::int32_t) j;
+			}
+		}
+	}
+
+	void SweepAndPrune::sweep()
+	{
+		m_NewPairs.clear();
+
+		std::size_t const entryCount = m_SortedEntries.size();
+		for (std::size_t i = 0; i < entryCount; i++)
+		{
+			SortedEntry const& entry = m_SortedEntries[i];
+
+			// Only the entries starting before this one ends can overlap with it on x, touching entries included.
+			for (std::size_t j = i + 1; j < entryCount && m_SortedEntries[j].MinX <= entry.MaxX; j++)
+			{
+				SortedEntry const& other = m_SortedEntries[j];
+				if (other.MaxY < entry.MinY || other.MinY > entry.MaxY)
+				{
+					continue;
+				}
+
+				if ((entry.CategoryBits & other.MaskBits) == 0 || (other.CategoryBits & entry.MaskBits) == 0)
+				{
+					continue;
+				}
+
+				m_NewPairs.push_back(pairKeyOf(entry.ProxyId, other.ProxyId));
+			}
+		}
+
+		std::sort(m_NewPairs.begin(), m_NewPairs.end());
+	}
+
+	void SweepAndPrune::addPairEvents()
+	{
+		m_PairEvents.clear();
+
+		auto addEvent = [this](bool isBegin, PairKey pair)
+		{
+			m_PairEvents.push_back(PairEvent {isBegin, m_Proxies[proxyAOf(pair)].UserData, m_Proxies[proxyBOf(pair)].UserData});
+		};
+
+		// Both pair lists are sorted, walk them together to find the new and the lost pairs.
+		std::size_t previousIndex = 0;
+		std::size_t currentIndex = 0;
+		while (previousIndex < m_Pairs.size() || currentIndex < m_NewPairs.size())
+		{
+			if (currentIndex == m_NewPairs.size() || (previousIndex < m_Pairs.size() && m_Pairs[previousIndex] < m_NewPairs[currentIndex]))
+			{
+				addEvent(false, m_Pairs[previousIndex]);
+				previousIndex++;
+			}
+			else if (previousIndex == m_Pairs.size() || m_NewPairs[currentIndex] < m_Pairs[previousIndex])
+			{
+				addEvent(true, m_NewPairs[currentIndex]);
+				currentIndex++;
+			}
+			else
+			{
+				previousIndex++;
+				currentIndex++;
+			}
+		}
+	}
+}
\ No newline at end of file
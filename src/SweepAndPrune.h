@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Math/AABB.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace DYE
+{
+	/// Keeps every pair of overlapping proxies with a sort and sweep on the x axis.
+	/// The proxies are kept sorted by their min x between updates, so re-sorting them with an insertion sort
+	/// only costs the few swaps of the proxies that moved past each other: a mostly static update is close to O(n),
+	/// plus the pairs overlapping on x. The pairs of an update are compared with the pairs of the last one to publish begin/end events.
+	class SweepAndPrune
+	{
+	public:
+		constexpr static std::int32_t NullProxy = -1;
+		constexpr static std::uint32_t AllCategoryBits = ~0u;
+
+		struct PairEvent
+		{
+			// True if the proxies started overlapping since the last update, false if they stopped.
+			bool IsBegin;
+			std::uint64_t UserDataA;
+			std::uint64_t UserDataB;
+		};
+
+		/// \param categoryBits, maskBits two proxies are paired if the category bits of each one share a bit with the mask bits of the other one.
+		std::int32_t CreateProxy(Math::AABB const& aabb, std::uint64_t userData,
+								 std::uint32_t categoryBits = AllCategoryBits, std::uint32_t maskBits = AllCategoryBits);
+
+		/// The pairs of a destroyed proxy end at the next update, the proxy id is only reused after that.
+		void DestroyProxy(std::int32_t proxyId);
+		void MoveProxy(std::int32_t proxyId, Math::AABB const& aabb);
+		void SetFilterBits(std::int32_t proxyId, std::uint32_t categoryBits, std::uint32_t maskBits);
+
+		std::uint64_t GetUserData(std::int32_t proxyId) const { return m_Proxies[proxyId].UserData; }
+
+		void Clear();
+
+		/// Re-sort the proxies, find all the overlapping pairs and replace the pair events with the changes since the last update.
+		void UpdatePairs();
+
+		/// The events of the last UpdatePairs() call.
+		std::span<PairEvent const> GetPairEvents() const { return m_PairEvents; }
+
+		std::size_t GetPairCount() const { return m_Pairs.size(); }
+
+		/// Visit the pairs found by the last UpdatePairs() call.
+		/// \param callback void(std::uint64_t userDataA, std::uint64_t userDataB).
+		template<typename Callback>
+		void ForEachPair(Callback&& callback) const
+		{
+			for (PairKey const pair : m_Pairs)
+			{
+				callback(m_Proxies[proxyAOf(pair)].UserData, m_Proxies[proxyBOf(pair)].UserData);
+			}
+		}
+
+	private:
+		// The ids of the two proxies, the smaller one in the high bits so the keys sort by their first proxy.
+		using PairKey = std::uint64_t;
+
+		/// A proxy in the sweep order, the bounds are copied here so the sweep reads the entries sequentially.
+		struct SortedEntry
+		{
+			float MinX;
+			float MaxX;
+			float MinY;
+			float MaxY;
+			std::uint32_t CategoryBits;
+			std::uint32_t MaskBits;
+			std::int32_t ProxyId;
+		};
+
+		struct Proxy
+		{
+			std::uint64_t UserData = 0;
+
+			// Index into the sorted entries when the proxy is in use, otherwise the next free proxy.
+			std::int32_t SortedIndexOrNext = NullProxy;
+			bool IsInUse = false;
+			bool IsDestroyed = false;
+		};
+
+		static PairKey pairKeyOf(std::int32_t proxyA, std::int32_t proxyB)
+		{
+			if (proxyA > proxyB)
+			{
+				std::swap(proxyA, proxyB);
+			}
+			return ((PairKey) (std::uint32_t) proxyA << 32) | (PairKey) (std::uint32_t) proxyB;
+		}
+
+		static std::int32_t proxyAOf(PairKey pair) { return (std::int32_t) (pair >> 32); }
+		static std::int32_t proxyBOf(PairKey pair) { return (std::int32_t) (pair & 0xFFFFFFFFu); }
+
+		void removeDestroyedEntries();
+		void sortEntries();
+		void sweep();
+		void addPairEvents();
+
+	private:
+		std::vector<Proxy> m_Proxies;
+		std::int32_t m_FreeList = NullProxy;
+		// Proxies destroyed since the last update, freed once their pairs have ended.
+		std::vector<std::int32_t> m_DestroyedProxies;
+
+		std::vector<SortedEntry> m_SortedEntries;
+
+		// Sorted pair keys of the last update, and the buffer the current update sweeps into.
+		std::vector<PairKey> m_Pairs;
+		std::vector<PairKey> m_NewPairs;
+		std::vector<PairEvent> m_PairEvents;
+	};
+}
\ No newline at end of file
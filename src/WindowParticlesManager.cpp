@@ -1,4 +1,5 @@
 #include "WindowParticlesManager.h"
+#include "ImGuiPagedList.h"
 
 #include "Graphics/WindowManager.h"
 #include "Math/Math.h"
@@ -196,27 +197,33 @@ namespace DYE
 	{
 		if (ImGui::Begin("Window Particles Debugger"))
 		{
-			int updatedCount = 0;
-			for (auto& particle : m_Particles)
+			ImGui::InputInt("Find Particle Index (-1 for all)", &m_InspectorIndexFilter);
+
+			// One pass counts the active particles and collects the ones listed.
+			int activeCount = 0;
+			m_InspectorRows.clear();
+			for (std::uint32_t index = 0; index < m_Particles.size(); index++)
 			{
-				if (particle.IsPlaying)
+				if (!m_Particles[index].IsPlaying)
 				{
-					updatedCount++;
+					continue;
 				}
-			}
 
-			ImGuiUtil::DrawReadOnlyTextWithLabel("Number Of Active Particles", std::to_string(updatedCount));
-			for (auto& particle : m_Particles)
-			{
-				if (!particle.IsPlaying)
+				activeCount++;
+				if (m_InspectorIndexFilter < 0 || index == (std::uint32_t) m_InspectorIndexFilter)
 				{
-					continue;
+					m_InspectorRows.push_back(index);
 				}
+			}
+
+			ImGuiUtil::DrawReadOnlyTextWithLabel("Number Of Active Particles", std::to_string(activeCount));
+			ImGuiPagedList::Draw("Particles", m_InspectorRows, m_InspectorPage, [this](std::uint32_t index)
+			{
+				WindowParticle& particle = m_Particles[index];
 				ImGui::Separator();
-				ImGuiUtil::DrawReadOnlyTextWithLabel("Life Time", std::to_string(particle.Timer) + "/" + std::to_string(particle.LifeTime));
-				ImGuiUtil::DrawReadOnlyTextWithLabel("Size", std::to_string(particle.GetSize()));
+				ImGui::Text("Particle %u, Life Time %.2f/%.2f, Size %.1f", index, particle.Timer, particle.LifeTime, particle.GetSize());
 				ImGuiUtil::DrawVector2Control("Position", particle.Position);
-			}
+			});
 		}
 		ImGui::End();
 	}
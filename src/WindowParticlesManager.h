@@ -3,6 +3,7 @@
 #include "Graphics/WindowBase.h"
 #include "Math/EasingFunctions.h"
 
+#include <cstdint>
 #include <vector>
 #include <glm/glm.hpp>
 
@@ -50,6 +51,11 @@ namespace DYE
 		std::vector<WindowParticle> m_Particles;
 		bool m_ShowParticle = false;
 
+		// The state of the OnImGui() inspector. The rows are the indices of the listed particles, kept so the listing doesn't allocate.
+		int m_InspectorIndexFilter = -1;
+		int m_InspectorPage = 0;
+		std::vector<std::uint32_t> m_InspectorRows;
+
 	public:
 		bool HasMaxParticlesLimit = false;
 		int MaxParticlesLimit = 20;
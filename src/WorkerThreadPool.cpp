@@ -0,0 +1,124 @@
+#include "WorkerThreadPool.h"
+
+#include <algorithm>
+
+namespace DYE
+{
+	std::uint32_t WorkerThreadPool::GetDefaultWorkerCount()
+	{
+		std::uint32_t const hardwareThreadCount = std::thread::hardware_concurrency();
+		return hardwareThreadCount > 1? hardwareThreadCount - 1 : 0;
+	}
+
+	WorkerThreadPool::WorkerThreadPool(std::uint32_t workerCount)
+	{
+		m_Workers.reserve(workerCount);
+		for (std::uint32_t i = 0; i < workerCount; i++)
+		{
+			m_Workers.emplace_back(&WorkerThreadPool::workerMain, this);
+		}
+	}
+
+	WorkerThreadPool::~WorkerThreadPool()
+	{
+		{
+			std::lock_guard lock(m_Mutex);
+			m_IsStopping = true;
+		}
+		m_LoopStartedCondition.notify_all();
+
+		for (auto& worker : m_Workers)
+		{
+			worker.join();
+		}
+	}
+
+	void WorkerThreadPool::parallelFor(std::uint32_t count, std::uint32_t grainSize, JobFunction jobFunction, void* pJob)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+
+		grainSize = std::max(grainSize, 1u);
+		if (m_Workers.empty() || count <= grainSize)
+		{
+			// Not worth waking up the workers.
+			for (std::uint32_t index = 0; index < count; index++)
+			{
+				jobFunction(pJob, index);
+			}
+			return;
+		}
+
+		{
+			std::lock_guard lock(m_Mutex);
+			m_JobFunction = jobFunction;
+			m_pJob = pJob;
+			m_Count = count;
+			m_GrainSize = grainSize;
+			m_NextIndex.store(0, std::memory_order_relaxed);
+			m_BusyWorkerCount = (std::uint32_t) m_Workers.size();
+			m_LoopGeneration++;
+		}
+		m_LoopStartedCondition.notify_all();
+
+		runBatches();
+
+		// The job lives on the caller's stack, wait until no worker can touch it anymore.
+		std::unique_lock lock(m_Mutex);
+		m_LoopFinishedCondition.wait(lock, [this]() { return m_BusyWorkerCount == 0; });
+		m_JobFunction = nullptr;
+		m_pJob = nullptr;
+	}
+
+	void WorkerThreadPool::workerMain()
+	{
+		std::uint64_t lastLoopGeneration = 0;
+		while (true)
+		{
+			{
+				std::unique_lock lock(m_Mutex);
+				m_LoopStartedCondition.wait(lock, [&]() { return m_IsStopping || m_LoopGeneration != lastLoopGeneration; });
+				if (m_IsStopping)
+				{
+					return;
+				}
+
+				lastLoopGeneration = m_LoopGeneration;
+			}
+
+			runBatches();
+
+			bool isLastWorker;
+			{
+				std::lock_guard lock(m_Mutex);
+				m_BusyWorkerCount--;
+				isLastWorker = m_BusyWorkerCount == 0;
+			}
+
+			if (isLastWorker)
+			{
+				m_LoopFinishedCondition.notify_one();
+			}
+		}
+	}
+
+	void WorkerThreadPool::runBatches()
+	{
+		while (true)
+		{
+			std::uint32_t const begin = m_NextIndex.fetch_add(m_GrainSize, std::memory_order_relaxed);
+			if (begin >= m_Count)
+			{
+				return;
+			}
+
+			std::uint32_t const end = std::min(begin + m_GrainSize, m_Count);
+			for (std::uint32_t index = begin; index < end; index++)
+			{
+				m_JobFunction(m_pJob, index);
+			}
+		}
+	}
+}
\ No newline at end of file
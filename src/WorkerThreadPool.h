@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace DYE
+{
+	/// A fixed set of worker threads that split data parallel loops with the calling thread.
+	/// Only one loop runs at a time, ParallelFor() blocks until every index has been processed.
+	class WorkerThreadPool
+	{
+	public:
+		/// Leave one hardware thread for the calling thread, which also takes part in every loop.
+		static std::uint32_t GetDefaultWorkerCount();
+
+		explicit WorkerThreadPool(std::uint32_t workerCount = GetDefaultWorkerCount());
+		~WorkerThreadPool();
+
+		WorkerThreadPool(WorkerThreadPool const& other) = delete;
+		WorkerThreadPool& operator=(WorkerThreadPool const& other) = delete;
+
+		std::uint32_t GetWorkerCount() const { return (std::uint32_t) m_Workers.size(); }
+
+		/// Call job(index) for every index in [0, count), the indices are handed out in batches of grainSize.
+		/// The job is called concurrently from several threads, it must only write to state owned by its index.
+		template<typename Job>
+		void ParallelFor(std::uint32_t count, std::uint32_t grainSize, Job&& job)
+		{
+			auto invokeJob = [](void* pJob, std::uint32_t index) { (*static_cast<std::remove_reference_t<Job>*>(pJob))(index); };
+			parallelFor(count, grainSize, invokeJob, (void*) &job);
+		}
+
+	private:
+		using JobFunction = void (*)(void* pJob, std::uint32_t index);
+
+		void parallelFor(std::uint32_t count, std::uint32_t grainSize, JobFunction jobFunction, void* pJob);
+		void workerMain();
+
+		/// Claim batches of indices of the current loop until there is none left.
+		void runBatches();
+
+	private:
+		std::vector<std::thread> m_Workers;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_LoopStartedCondition;
+		std::condition_variable m_LoopFinishedCondition;
+
+		// Bumped for every loop so the workers can tell a new loop from a spurious wake up.
+		std::uint64_t m_LoopGeneration = 0;
+		std::uint32_t m_BusyWorkerCount = 0;
+		bool m_IsStopping = false;
+
+		// The current loop, written under the mutex before the workers are woken up.
+		JobFunction m_JobFunction = nullptr;
+		void* m_pJob = nullptr;
+		std::uint32_t m_Count = 0;
+		std::uint32_t m_GrainSize = 1;
+		std::atomic<std::uint32_t> m_NextIndex = 0;
+	};
+}
\ No newline at end of file